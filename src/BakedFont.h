@@ -0,0 +1,36 @@
+#pragma once
+// Layout of the pre-rasterized font blob written by tools/bake_font_atlas and embedded into the library.
+// Everything is little-endian and 4-byte aligned so the blob is read in place: a header, BakedFontBucket[bucketCount],
+// then per bucket BakedFontGlyph[glyphCount] sorted by codepoint, and Alpha8 pixels referenced by byte offset from the blob start.
+
+#include <cstddef>
+#include <cstdint>
+
+static constexpr uint32_t kBakedFontMagic = 0x31464141; // "AAF1"
+static constexpr uint32_t kBakedFontVersion = 1;
+
+// Overlay fonts are ProggyClean at 18 px per 720 lines of height, with the scale clamped to [1.5, 4] and snapped to quarter steps
+// so every device lands on one of the baked sizes.
+static constexpr float kBakedFontBaseSize = 18.0f, kBakedFontScaleMin = 1.5f, kBakedFontScaleMax = 4.0f, kBakedFontScaleStep = 0.25f;
+
+struct BakedFontHeader { uint32_t magic, version, imguiVersion, bucketCount; };
+struct BakedFontBucket { float sizePixels; uint32_t glyphCount, glyphOffset, reserved; }; // sizePixels: the rounded size ImGui bakes at
+struct BakedFontGlyph { uint32_t codepoint; uint16_t w, h; float x0, y0, x1, y1, advanceX; uint32_t pixelOffset; }; // w == 0: nothing to draw
+
+static inline const BakedFontHeader* bakedFontHeader(const void* blob, size_t size, uint32_t imguiVersion) {
+    const BakedFontHeader* header = (const BakedFontHeader*)blob;
+    if (!blob || size < sizeof(BakedFontHeader) || header->magic != kBakedFontMagic || header->version != kBakedFontVersion || header->imguiVersion != imguiVersion) return nullptr;
+    if (size < sizeof(BakedFontHeader) + header->bucketCount * sizeof(BakedFontBucket)) return nullptr;
+    return header;
+}
+
+static inline const BakedFontBucket* bakedFontBuckets(const BakedFontHeader* header) { return (const BakedFontBucket*)(header + 1); }
+static inline const BakedFontGlyph* bakedFontGlyphs(const BakedFontHeader* header, const BakedFontBucket& bucket) { return (const BakedFontGlyph*)((const uint8_t*)header + bucket.glyphOffset); }
+static inline const uint8_t* bakedFontPixels(const BakedFontHeader* header, const BakedFontGlyph& glyph) { return (const uint8_t*)header + glyph.pixelOffset; }
+
+static inline const BakedFontGlyph* bakedFontFindGlyph(const BakedFontHeader* header, const BakedFontBucket& bucket, uint32_t codepoint) {
+    const BakedFontGlyph* glyphs = bakedFontGlyphs(header, bucket);
+    size_t lo = 0, hi = bucket.glyphCount;
+    while (lo < hi) { size_t mid = (lo + hi) / 2; if (glyphs[mid].codepoint < codepoint) lo = mid + 1; else hi = mid; }
+    return lo < bucket.glyphCount && glyphs[lo].codepoint == codepoint ? &glyphs[lo] : nullptr;
+}
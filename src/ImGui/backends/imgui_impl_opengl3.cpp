@@ -165,6 +165,9 @@
 #include <OpenGLES/ES3/gl.h>    // Use GL ES 3
 #else
 #include <GLES3/gl3.h>          // Use GL ES 3
+#if !defined(__EMSCRIPTEN__)
+#include <EGL/egl.h>            // eglGetProcAddress() for glDrawElementsBaseVertex() (ES 3.2 or OES/EXT_draw_elements_base_vertex)
+#endif
 #endif
 #elif !defined(IMGUI_IMPL_OPENGL_LOADER_CUSTOM)
 // Modern desktop OpenGL doesn't have a standard portable header file to load OpenGL function pointers.
@@ -213,11 +216,25 @@
 #define IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
 #endif
 
+// GL ES 3.2 has glDrawElementsBaseVertex() in core, ES 3.0/3.1 may have it through GL_OES_draw_elements_base_vertex or GL_EXT_draw_elements_base_vertex.
+// Not in the headers we include, so it is fetched at runtime with eglGetProcAddress().
+#if defined(IMGUI_IMPL_OPENGL_ES3) && !defined(__APPLE__) && !defined(__EMSCRIPTEN__)
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_EXT_VTX_OFFSET
+typedef void (GL_APIENTRYP ImGui_ImplOpenGL3_DrawElementsBaseVertexProc)(GLenum mode, GLsizei count, GLenum type, const void* indices, GLint basevertex);
+#endif
+
 // Desktop GL 3.3+ and GL ES 3.0+ have glBindSampler()
 #if !defined(IMGUI_IMPL_OPENGL_ES2) && (defined(IMGUI_IMPL_OPENGL_ES3) || defined(GL_VERSION_3_3))
 #define IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
 #endif
 
+// GL ES 3.0+ has glMapBufferRange() and fence sync objects, which we use for the streaming vertex/index buffer.
+// (Desktop GL 3.2+ also has them but our stripped loader doesn't expose the symbols)
+#if defined(IMGUI_IMPL_OPENGL_ES3)
+#define IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+#endif
+#define IMGUI_IMPL_OPENGL_STREAM_SEGMENTS   3   // Frames in flight before a stream buffer segment gets overwritten
+
 // [Debugging]
 //#define IMGUI_IMPL_OPENGL_DEBUG
 #ifdef IMGUI_IMPL_OPENGL_DEBUG
@@ -226,6 +243,20 @@
 #else
 #define GL_CALL(_CALL)      _CALL   // Call without error check
 #endif
+// Render path calls are counted in ImGui_ImplOpenGL3_FrameStats::GlCalls ('bd' must be in scope)
+#define GL_CALL_COUNTED(_CALL)  do { bd->FrameStats.GlCalls++; GL_CALL(_CALL); } while (0)
+#define GL_COUNTED(_EXPR)       (bd->FrameStats.GlCalls++, _EXPR)   // For calls used as expressions
+
+// A buffer split in IMGUI_IMPL_OPENGL_STREAM_SEGMENTS segments that are written in turn with unsynchronized maps, each guarded by a fence (ES 3.0+)
+struct ImGui_ImplOpenGL3_BufferRing
+{
+    GLuint          Handle;
+    GLsizeiptr      SegmentSize;
+    int             Segment;                 // Last mapped segment
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+    GLsync          Fences[IMGUI_IMPL_OPENGL_STREAM_SEGMENTS];
+#endif
+};
 
 // OpenGL Data
 struct ImGui_ImplOpenGL3_Data
@@ -240,6 +271,7 @@ struct ImGui_ImplOpenGL3_Data
     GLuint          ShaderHandle;
     GLint           AttribLocationTex;       // Uniforms location
     GLint           AttribLocationProjMtx;
+    GLint           AttribLocationUseSdf;
     GLuint          AttribLocationVtxPos;    // Vertex attributes location
     GLuint          AttribLocationVtxUV;
     GLuint          AttribLocationVtxColor;
@@ -249,8 +281,35 @@ struct ImGui_ImplOpenGL3_Data
     bool            HasPolygonMode;
     bool            HasBindSampler;
     bool            HasClipOrigin;
+    bool            HasBaseVertex;           // glDrawElementsBaseVertex() is usable (desktop GL 3.2+, ES 3.2 or extension)
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_EXT_VTX_OFFSET
+    ImGui_ImplOpenGL3_DrawElementsBaseVertexProc DrawElementsBaseVertex;
+#endif
     bool            UseBufferSubData;
+    bool            UseStreamBuffer;         // Upload all draw lists into a fenced ring buffer with one glMapBufferRange() per frame (ES 3.0+). Cleared if fences or mapping misbehave.
+    bool            StreamBufferActive;      // Stream buffer holds the current frame's vertices/indices
+    ImGui_ImplOpenGL3_BufferRing StreamRing; // One segment per frame in flight
+    bool            UseUploadBuffer;         // Stage texture updates in a pixel unpack ring and copy grown atlases GPU-side (ES 3.0+). Cleared if fences or mapping misbehave.
+    ImGui_ImplOpenGL3_BufferRing UploadRing; // One segment per texture update call
+    GLuint          CopyFbos[2];             // Draw/read framebuffers for GPU-side texture copies
+    ImGui_ImplOpenGL3_FrameStats FrameStats; // Counters for the last RenderDrawData() call, see ImGui_ImplOpenGL3_GetFrameStats()
+
+    // State cache: what we last established, so SetupRenderState() and draws only issue deltas (see ImGui_ImplOpenGL3_InvalidateState())
+    bool            BackupState;             // Save/restore the host's GL state around RenderDrawData(). Default true, see ImGui_ImplOpenGL3_SetStateBackup().
+    ImGui_ImplOpenGL3_StateFlags StateValid; // Groups whose cached values below still match the context
+    GLuint          VaoHandle;               // Kept across frames when BackupState is false, otherwise recreated every frame
+    GLint           CachedViewport[4];
+    GLint           CachedScissor[4];
+    GLuint          CachedTexture;
+    GLuint          CachedArrayBuffer;
+    GLuint          CachedElementBuffer;
+    GLsizeiptr      CachedAttribOffset;
+    float           CachedProjection[4];     // L, R, T, B last uploaded to AttribLocationProjMtx. Uniforms are program state so the host can't change them.
+    bool            ProjectionValid;
+    int             CachedUseSdf;            // Last value uploaded to AttribLocationUseSdf
     ImVector<char>  TempBuffer;
+    ImGui_ImplOpenGL3_LoadProgramFunc   LoadProgramFunc;    // Optional program binary cache (see ImGui_ImplOpenGL3_SetProgramCache)
+    ImGui_ImplOpenGL3_StoreProgramFunc  StoreProgramFunc;
 
     ImGui_ImplOpenGL3_Data() { memset((void*)this, 0, sizeof(*this)); }
 };
@@ -342,6 +401,12 @@ bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
         bd->GlProfileIsES3 = true;
 #endif
 
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+    bd->UseStreamBuffer = (bd->GlProfileIsES3 && bd->GlVersion >= 300);
+    bd->UseUploadBuffer = (bd->GlProfileIsES3 && bd->GlVersion >= 300);
+#endif
+    bd->BackupState = true;
+
 #if defined(GL_CONTEXT_PROFILE_MASK)
     if (!bd->GlProfileIsES3 && bd->GlVersion >= 320)
         glGetIntegerv(GL_CONTEXT_PROFILE_MASK, &bd->GlProfileMask);
@@ -364,9 +429,29 @@ bool    ImGui_ImplOpenGL3_Init(const char* glsl_version)
 #endif
 
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
-    if (bd->GlVersion >= 320)
-        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
+    bd->HasBaseVertex = (bd->GlVersion >= 320);
 #endif
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_EXT_VTX_OFFSET
+    if (bd->GlProfileIsES3)
+    {
+        const char* entry_point = (bd->GlVersion >= 320) ? "glDrawElementsBaseVertex" : nullptr;
+        GLint num_extensions = 0;
+        glGetIntegerv(GL_NUM_EXTENSIONS, &num_extensions);
+        for (GLint i = 0; i < num_extensions && entry_point == nullptr; i++)
+        {
+            const char* extension = (const char*)glGetStringi(GL_EXTENSIONS, i);
+            if (extension != nullptr && strcmp(extension, "GL_OES_draw_elements_base_vertex") == 0)
+                entry_point = "glDrawElementsBaseVertexOES";
+            else if (extension != nullptr && strcmp(extension, "GL_EXT_draw_elements_base_vertex") == 0)
+                entry_point = "glDrawElementsBaseVertexEXT";
+        }
+        if (entry_point != nullptr)
+            bd->DrawElementsBaseVertex = (ImGui_ImplOpenGL3_DrawElementsBaseVertexProc)eglGetProcAddress(entry_point);
+        bd->HasBaseVertex = (bd->DrawElementsBaseVertex != nullptr);
+    }
+#endif
+    if (bd->HasBaseVertex)
+        io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;  // We can honor the ImDrawCmd::VtxOffset field, allowing for large meshes.
     io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;       // We can honor ImGuiPlatformIO::Textures[] requests during render.
 
     ImGuiPlatformIO& platform_io = ImGui::GetPlatformIO();
@@ -449,33 +534,138 @@ void    ImGui_ImplOpenGL3_NewFrame()
             IM_ASSERT(0 && "ImGui_ImplOpenGL3_CreateDeviceObjects() failed!");
 }
 
+void    ImGui_ImplOpenGL3_SetProgramCache(ImGui_ImplOpenGL3_LoadProgramFunc load_func, ImGui_ImplOpenGL3_StoreProgramFunc store_func)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    bd->LoadProgramFunc = load_func;
+    bd->StoreProgramFunc = store_func;
+}
+
+ImGui_ImplOpenGL3_FrameStats ImGui_ImplOpenGL3_GetFrameStats()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    return bd ? bd->FrameStats : ImGui_ImplOpenGL3_FrameStats();
+}
+
+void    ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags flags)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    bd->StateValid &= ~flags;
+    if (flags & ImGui_ImplOpenGL3_StateFlags_Viewport)
+        bd->CachedViewport[2] = -1;
+    if (flags & ImGui_ImplOpenGL3_StateFlags_Scissor)
+        bd->CachedScissor[2] = -1;
+    if (flags & ImGui_ImplOpenGL3_StateFlags_Texture)
+        bd->CachedTexture = (GLuint)-1;
+    if (flags & ImGui_ImplOpenGL3_StateFlags_VertexArray)
+    {
+        bd->CachedArrayBuffer = bd->CachedElementBuffer = (GLuint)-1;
+        bd->CachedAttribOffset = -1;
+    }
+}
+
+void    ImGui_ImplOpenGL3_SetStateBackup(bool enabled)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    IM_ASSERT(bd != nullptr && "Context or backend not initialized! Did you call ImGui_ImplOpenGL3_Init()?");
+    bd->BackupState = enabled;
+    ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags_All);
+}
+
+// A draw call being accumulated from consecutive ImDrawCmd, see ImGui_ImplOpenGL3_RenderDrawData()
+struct ImGui_ImplOpenGL3_PendingDraw
+{
+    GLuint      TexID;
+    GLint       Scissor[4];
+    GLsizeiptr  IdxOffset;      // In bytes, into the bound GL_ELEMENT_ARRAY_BUFFER
+    GLsizei     ElemCount;
+    GLint       BaseVertex;
+    bool        UseSdf;         // Texture holds signed distance fields (ImTextureData::UseSdf)
+};
+
+static void ImGui_ImplOpenGL3_FlushDraw(ImGui_ImplOpenGL3_PendingDraw* draw)
+{
+    if (draw->ElemCount == 0)
+        return;
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (memcmp(bd->CachedScissor, draw->Scissor, sizeof(draw->Scissor)) != 0)
+    {
+        GL_CALL_COUNTED(glScissor(draw->Scissor[0], draw->Scissor[1], draw->Scissor[2], draw->Scissor[3]));
+        memcpy(bd->CachedScissor, draw->Scissor, sizeof(draw->Scissor));
+    }
+    if (bd->CachedTexture != draw->TexID)
+    {
+        GL_CALL_COUNTED(glBindTexture(GL_TEXTURE_2D, draw->TexID));
+        bd->CachedTexture = draw->TexID;
+    }
+    if (bd->CachedUseSdf != (int)draw->UseSdf)
+    {
+        GL_CALL_COUNTED(glUniform1i(bd->AttribLocationUseSdf, draw->UseSdf));
+        bd->CachedUseSdf = draw->UseSdf;
+    }
+    const GLenum idx_type = sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+#if defined(IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET)
+    if (bd->HasBaseVertex)
+        GL_CALL_COUNTED(glDrawElementsBaseVertex(GL_TRIANGLES, draw->ElemCount, idx_type, (void*)(intptr_t)draw->IdxOffset, draw->BaseVertex));
+    else
+#elif defined(IMGUI_IMPL_OPENGL_MAY_HAVE_EXT_VTX_OFFSET)
+    if (draw->BaseVertex != 0 && bd->HasBaseVertex)
+        GL_CALL_COUNTED(bd->DrawElementsBaseVertex(GL_TRIANGLES, draw->ElemCount, idx_type, (void*)(intptr_t)draw->IdxOffset, draw->BaseVertex));
+    else
+#endif
+    GL_CALL_COUNTED(glDrawElements(GL_TRIANGLES, draw->ElemCount, idx_type, (void*)(intptr_t)draw->IdxOffset));
+    bd->FrameStats.DrawCalls++;
+    draw->ElemCount = 0;
+}
+
+// Point ImDrawVert attributes at 'vtx_offset' bytes into the bound GL_ARRAY_BUFFER
+static void ImGui_ImplOpenGL3_SetupVertexAttribs(GLsizeiptr vtx_offset)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (bd->CachedAttribOffset == vtx_offset)
+        return;
+    GL_CALL_COUNTED(glVertexAttribPointer(bd->AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + offsetof(ImDrawVert, pos))));
+    GL_CALL_COUNTED(glVertexAttribPointer(bd->AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + offsetof(ImDrawVert, uv))));
+    GL_CALL_COUNTED(glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)(vtx_offset + offsetof(ImDrawVert, col))));
+    bd->CachedAttribOffset = vtx_offset;
+}
+
 static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_width, int fb_height, GLuint vertex_array_object)
 {
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
 
     // Setup render state: alpha-blending enabled, no face culling, no depth testing, scissor enabled, polygon fill
-    glEnable(GL_BLEND);
-    glBlendEquation(GL_FUNC_ADD);
-    glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
-    glDisable(GL_CULL_FACE);
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_STENCIL_TEST);
-    glEnable(GL_SCISSOR_TEST);
+    // Groups still flagged in bd->StateValid were set by us and not touched by the host since, so they are skipped.
+    if (!(bd->StateValid & ImGui_ImplOpenGL3_StateFlags_Blend))
+    {
+        GL_CALL_COUNTED(glEnable(GL_BLEND));
+        GL_CALL_COUNTED(glBlendEquation(GL_FUNC_ADD));
+        GL_CALL_COUNTED(glBlendFuncSeparate(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA, GL_ONE, GL_ONE_MINUS_SRC_ALPHA));
+    }
+    if (!(bd->StateValid & ImGui_ImplOpenGL3_StateFlags_Capabilities))
+    {
+        GL_CALL_COUNTED(glDisable(GL_CULL_FACE));
+        GL_CALL_COUNTED(glDisable(GL_DEPTH_TEST));
+        GL_CALL_COUNTED(glDisable(GL_STENCIL_TEST));
+        GL_CALL_COUNTED(glEnable(GL_SCISSOR_TEST));
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
-    if (!bd->GlProfileIsES3 && bd->GlVersion >= 310)
-        glDisable(GL_PRIMITIVE_RESTART);
+        if (!bd->GlProfileIsES3 && bd->GlVersion >= 310)
+            GL_CALL_COUNTED(glDisable(GL_PRIMITIVE_RESTART));
 #endif
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
-    if (bd->HasPolygonMode)
-        glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        if (bd->HasPolygonMode)
+            GL_CALL_COUNTED(glPolygonMode(GL_FRONT_AND_BACK, GL_FILL));
 #endif
+    }
 
     // Support for GL 4.5 rarely used glClipControl(GL_UPPER_LEFT)
 #if defined(GL_CLIP_ORIGIN)
     bool clip_origin_lower_left = true;
     if (bd->HasClipOrigin)
     {
-        GLenum current_clip_origin = 0; glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&current_clip_origin);
+        GLenum current_clip_origin = 0; GL_CALL_COUNTED(glGetIntegerv(GL_CLIP_ORIGIN, (GLint*)&current_clip_origin));
         if (current_clip_origin == GL_UPPER_LEFT)
             clip_origin_lower_left = false;
     }
@@ -483,7 +673,12 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
 
     // Setup viewport, orthographic projection matrix
     // Our visible imgui space lies from draw_data->DisplayPos (top left) to draw_data->DisplayPos+data_data->DisplaySize (bottom right). DisplayPos is (0,0) for single viewport apps.
-    GL_CALL(glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height));
+    const GLint viewport[4] = { 0, 0, fb_width, fb_height };
+    if (memcmp(bd->CachedViewport, viewport, sizeof(viewport)) != 0)
+    {
+        GL_CALL_COUNTED(glViewport(0, 0, (GLsizei)fb_width, (GLsizei)fb_height));
+        memcpy(bd->CachedViewport, viewport, sizeof(viewport));
+    }
     float L = draw_data->DisplayPos.x;
     float R = draw_data->DisplayPos.x + draw_data->DisplaySize.x;
     float T = draw_data->DisplayPos.y;
@@ -491,38 +686,304 @@ static void ImGui_ImplOpenGL3_SetupRenderState(ImDrawData* draw_data, int fb_wid
 #if defined(GL_CLIP_ORIGIN)
     if (!clip_origin_lower_left) { float tmp = T; T = B; B = tmp; } // Swap top and bottom if origin is upper left
 #endif
-    const float ortho_projection[4][4] =
+    if (!(bd->StateValid & ImGui_ImplOpenGL3_StateFlags_Program))
+        GL_CALL_COUNTED(glUseProgram(bd->ShaderHandle));
+    const float projection[4] = { L, R, T, B };
+    if (!bd->ProjectionValid || memcmp(bd->CachedProjection, projection, sizeof(projection)) != 0)
     {
-        { 2.0f/(R-L),   0.0f,         0.0f,   0.0f },
-        { 0.0f,         2.0f/(T-B),   0.0f,   0.0f },
-        { 0.0f,         0.0f,        -1.0f,   0.0f },
-        { (R+L)/(L-R),  (T+B)/(B-T),  0.0f,   1.0f },
-    };
-    glUseProgram(bd->ShaderHandle);
-    glUniform1i(bd->AttribLocationTex, 0);
-    glUniformMatrix4fv(bd->AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]);
+        const float ortho_projection[4][4] =
+        {
+            { 2.0f/(R-L),   0.0f,         0.0f,   0.0f },
+            { 0.0f,         2.0f/(T-B),   0.0f,   0.0f },
+            { 0.0f,         0.0f,        -1.0f,   0.0f },
+            { (R+L)/(L-R),  (T+B)/(B-T),  0.0f,   1.0f },
+        };
+        if (!bd->ProjectionValid)
+            GL_CALL_COUNTED(glUniform1i(bd->AttribLocationTex, 0));
+        GL_CALL_COUNTED(glUniformMatrix4fv(bd->AttribLocationProjMtx, 1, GL_FALSE, &ortho_projection[0][0]));
+        memcpy(bd->CachedProjection, projection, sizeof(projection));
+        bd->ProjectionValid = true;
+    }
 
+    if (!(bd->StateValid & ImGui_ImplOpenGL3_StateFlags_Texture))
+    {
+        GL_CALL_COUNTED(glActiveTexture(GL_TEXTURE0));
 #ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
-    if (bd->HasBindSampler)
-        glBindSampler(0, 0); // We use combined texture/sampler state. Applications using GL 3.3 and GL ES 3.0 may set that otherwise.
+        if (bd->HasBindSampler)
+            GL_CALL_COUNTED(glBindSampler(0, 0)); // We use combined texture/sampler state. Applications using GL 3.3 and GL ES 3.0 may set that otherwise.
 #endif
+    }
 
+    // Bind vertex/index buffers and setup attributes for ImDrawVert
+    // (The stream buffer holds both vertices and indices, ES 3.0 allows binding it to both targets)
     (void)vertex_array_object;
+    if (!(bd->StateValid & ImGui_ImplOpenGL3_StateFlags_VertexArray))
+    {
 #ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    glBindVertexArray(vertex_array_object);
+        GL_CALL_COUNTED(glBindVertexArray(vertex_array_object));
 #endif
+        GL_CALL_COUNTED(glEnableVertexAttribArray(bd->AttribLocationVtxPos));
+        GL_CALL_COUNTED(glEnableVertexAttribArray(bd->AttribLocationVtxUV));
+        GL_CALL_COUNTED(glEnableVertexAttribArray(bd->AttribLocationVtxColor));
+    }
+    const GLuint array_buffer = bd->StreamBufferActive ? bd->StreamRing.Handle : bd->VboHandle;
+    const GLuint element_buffer = bd->StreamBufferActive ? bd->StreamRing.Handle : bd->ElementsHandle;
+    if (bd->CachedArrayBuffer != array_buffer)
+    {
+        GL_CALL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, array_buffer));
+        bd->CachedArrayBuffer = array_buffer;
+        bd->CachedAttribOffset = -1;
+    }
+    if (bd->CachedElementBuffer != element_buffer)
+    {
+        GL_CALL_COUNTED(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, element_buffer));
+        bd->CachedElementBuffer = element_buffer;
+    }
+    ImGui_ImplOpenGL3_SetupVertexAttribs(0);
+    bd->StateValid = ImGui_ImplOpenGL3_StateFlags_All;
+}
 
-    // Bind vertex/index buffers and setup attributes for ImDrawVert
-    GL_CALL(glBindBuffer(GL_ARRAY_BUFFER, bd->VboHandle));
-    GL_CALL(glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, bd->ElementsHandle));
-    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxPos));
-    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxUV));
-    GL_CALL(glEnableVertexAttribArray(bd->AttribLocationVtxColor));
-    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxPos,   2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)offsetof(ImDrawVert, pos)));
-    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxUV,    2, GL_FLOAT,         GL_FALSE, sizeof(ImDrawVert), (GLvoid*)offsetof(ImDrawVert, uv)));
-    GL_CALL(glVertexAttribPointer(bd->AttribLocationVtxColor, 4, GL_UNSIGNED_BYTE, GL_TRUE, sizeof(ImDrawVert), (GLvoid*)offsetof(ImDrawVert, col)));
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+enum ImGui_ImplOpenGL3_RingResult
+{
+    ImGui_ImplOpenGL3_RingResult_Ok,
+    ImGui_ImplOpenGL3_RingResult_Busy,       // Next segment still in use by the GPU after 'timeout_ns'
+    ImGui_ImplOpenGL3_RingResult_Failed,     // Fences or mapping misbehave, stop using the ring
+};
+
+// Map 'size' bytes at the start of the next segment. The ring's buffer must be bound to 'target'.
+// Growing orphans the storage: the old one stays alive until the GPU is done with it, so pending fences can go.
+static ImGui_ImplOpenGL3_RingResult ImGui_ImplOpenGL3_MapRing(ImGui_ImplOpenGL3_BufferRing* ring, GLenum target, GLsizeiptr size, GLuint64 timeout_ns, void** out_data, GLsizeiptr* out_offset)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    if (ring->SegmentSize < size)
+    {
+        for (GLsync& fence : ring->Fences)
+            if (fence) { GL_CALL_COUNTED(glDeleteSync(fence)); fence = nullptr; }
+        ring->SegmentSize = (size + size / 2 + 0xFFFF) & ~(GLsizeiptr)0xFFFF;
+        ring->Segment = 0;
+        GL_CALL_COUNTED(glBufferData(target, ring->SegmentSize * IMGUI_IMPL_OPENGL_STREAM_SEGMENTS, nullptr, GL_DYNAMIC_DRAW));
+    }
+
+    const int segment = (ring->Segment + 1) % IMGUI_IMPL_OPENGL_STREAM_SEGMENTS;
+    if (GLsync fence = ring->Fences[segment])
+    {
+        GLenum result = GL_COUNTED(glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeout_ns));
+        if (result == GL_TIMEOUT_EXPIRED)
+            return ImGui_ImplOpenGL3_RingResult_Busy;
+        GL_CALL_COUNTED(glDeleteSync(fence));
+        ring->Fences[segment] = nullptr;
+        if (result != GL_ALREADY_SIGNALED && result != GL_CONDITION_SATISFIED)
+            return ImGui_ImplOpenGL3_RingResult_Failed;
+    }
+    ring->Segment = segment;
+    *out_offset = ring->SegmentSize * segment;
+    *out_data = GL_COUNTED(glMapBufferRange(target, *out_offset, size, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT));
+    return *out_data ? ImGui_ImplOpenGL3_RingResult_Ok : ImGui_ImplOpenGL3_RingResult_Failed;
+}
+
+// Fence the segment last mapped, once every command reading from it has been issued
+static bool ImGui_ImplOpenGL3_FenceRing(ImGui_ImplOpenGL3_BufferRing* ring)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    ring->Fences[ring->Segment] = GL_COUNTED(glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0));
+    return ring->Fences[ring->Segment] != nullptr;
 }
 
+static void ImGui_ImplOpenGL3_DestroyRing(ImGui_ImplOpenGL3_BufferRing* ring)
+{
+    for (GLsync& fence : ring->Fences)
+        if (fence) { glDeleteSync(fence); fence = nullptr; }
+    if (ring->Handle) { glDeleteBuffers(1, &ring->Handle); ring->Handle = 0; }
+    ring->SegmentSize = 0;
+    ring->Segment = 0;
+}
+
+static void ImGui_ImplOpenGL3_DestroyStreamBuffer()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    ImGui_ImplOpenGL3_DestroyRing(&bd->StreamRing);
+    ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags_VertexArray); // Deleting a bound buffer unbinds it
+}
+
+// Stop using the stream buffer for good and go back to per-list glBufferData() uploads.
+static void ImGui_ImplOpenGL3_DisableStreamBuffer()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    ImGui_ImplOpenGL3_DestroyStreamBuffer();
+    bd->UseStreamBuffer = false;
+#ifdef IMGUI_IMPL_OPENGL_DEBUG
+    fprintf(stderr, "Stream buffer disabled, falling back to glBufferData() uploads.\n");
+#endif
+}
+
+// Write every draw list back to back into the next segment of the stream buffer, using a single unsynchronized map.
+// The segment's fence from IMGUI_IMPL_OPENGL_STREAM_SEGMENTS frames ago tells us the GPU is done reading it.
+// Vertices come first and indices follow. With 'rebase_indices' every index is made relative to the first vertex of the frame,
+// so draws from different lists can be merged without glDrawElementsBaseVertex(). Returns false if the caller should upload with glBufferData() instead.
+static bool ImGui_ImplOpenGL3_UploadStreamBuffer(ImDrawData* draw_data, bool rebase_indices, GLsizeiptr* out_idx_base)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    const GLsizeiptr vtx_size = (GLsizeiptr)draw_data->TotalVtxCount * (int)sizeof(ImDrawVert);
+    const GLsizeiptr idx_size = (GLsizeiptr)draw_data->TotalIdxCount * (int)sizeof(ImDrawIdx);
+    const GLsizeiptr required = vtx_size + idx_size; // sizeof(ImDrawVert) is a multiple of 4 so indices stay aligned
+    if (required == 0)
+        return false;
+
+    if (bd->StreamRing.Handle == 0)
+        GL_CALL_COUNTED(glGenBuffers(1, &bd->StreamRing.Handle));
+    if (bd->CachedArrayBuffer != bd->StreamRing.Handle)
+    {
+        GL_CALL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, bd->StreamRing.Handle));
+        bd->CachedArrayBuffer = bd->StreamRing.Handle;
+        bd->CachedAttribOffset = -1;
+    }
+
+    // The segment was submitted several frames ago, so anything but a quick signal means the fences can't be trusted.
+    void* data = nullptr;
+    GLsizeiptr segment_offset = 0;
+    if (ImGui_ImplOpenGL3_MapRing(&bd->StreamRing, GL_ARRAY_BUFFER, required, 100 * 1000 * 1000, &data, &segment_offset) != ImGui_ImplOpenGL3_RingResult_Ok)
+    {
+        ImGui_ImplOpenGL3_DisableStreamBuffer();
+        return false;
+    }
+    char* dst = (char*)data;
+    ImDrawVert* dst_vtx = (ImDrawVert*)dst;
+    ImDrawIdx* dst_idx = (ImDrawIdx*)(dst + vtx_size);
+    unsigned int vtx_base = 0;
+    for (const ImDrawList* draw_list : draw_data->CmdLists)
+    {
+        memcpy(dst_vtx, draw_list->VtxBuffer.Data, (size_t)draw_list->VtxBuffer.Size * sizeof(ImDrawVert));
+        if (rebase_indices && vtx_base != 0)
+        {
+            for (const ImDrawIdx idx : draw_list->IdxBuffer)
+                *dst_idx++ = (ImDrawIdx)(idx + vtx_base);
+        }
+        else
+        {
+            memcpy(dst_idx, draw_list->IdxBuffer.Data, (size_t)draw_list->IdxBuffer.Size * sizeof(ImDrawIdx));
+            dst_idx += draw_list->IdxBuffer.Size;
+        }
+        dst_vtx += draw_list->VtxBuffer.Size;
+        vtx_base += (unsigned int)draw_list->VtxBuffer.Size;
+    }
+    if (GL_COUNTED(glUnmapBuffer(GL_ARRAY_BUFFER)) == GL_FALSE)
+    {
+        // Storage contents got lost (e.g. display mode change), orphan it and let the fallback path upload this frame.
+        ImGui_ImplOpenGL3_DisableStreamBuffer();
+        return false;
+    }
+    *out_idx_base = segment_offset + vtx_size;
+    bd->StreamBufferActive = true;
+    return true;
+}
+#endif
+
+// Host GL state saved by ImGui_ImplOpenGL3_RenderDrawData() and restored once it is done
+struct ImGui_ImplOpenGL3_BackupGLState
+{
+    GLenum      last_active_texture;
+    GLuint      last_program;
+    GLuint      last_texture;
+    GLuint      last_sampler;
+    GLuint      last_array_buffer;
+#ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
+    GLint       last_element_array_buffer;
+    ImGui_ImplOpenGL3_VtxAttribState last_vtx_attrib_state_pos, last_vtx_attrib_state_uv, last_vtx_attrib_state_color;
+#endif
+    GLuint      last_vertex_array_object;
+    GLint       last_polygon_mode[2];
+    GLint       last_viewport[4];
+    GLint       last_scissor_box[4];
+    GLenum      last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha;
+    GLenum      last_blend_equation_rgb, last_blend_equation_alpha;
+    GLboolean   last_enable_blend, last_enable_cull_face, last_enable_depth_test, last_enable_stencil_test, last_enable_scissor_test, last_enable_primitive_restart;
+
+    void Backup(ImGui_ImplOpenGL3_Data* bd)
+    {
+        GL_CALL_COUNTED(glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture));
+        GL_CALL_COUNTED(glActiveTexture(GL_TEXTURE0));
+        GL_CALL_COUNTED(glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&last_program));
+        GL_CALL_COUNTED(glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&last_texture));
+        last_sampler = 0;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
+        if (bd->HasBindSampler) { GL_CALL_COUNTED(glGetIntegerv(GL_SAMPLER_BINDING, (GLint*)&last_sampler)); }
+#endif
+        GL_CALL_COUNTED(glGetIntegerv(GL_ARRAY_BUFFER_BINDING, (GLint*)&last_array_buffer));
+#ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
+        // This is part of VAO on OpenGL 3.0+ and OpenGL ES 3.0+.
+        glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
+        last_vtx_attrib_state_pos.GetState(bd->AttribLocationVtxPos);
+        last_vtx_attrib_state_uv.GetState(bd->AttribLocationVtxUV);
+        last_vtx_attrib_state_color.GetState(bd->AttribLocationVtxColor);
+#endif
+#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
+        GL_CALL_COUNTED(glGetIntegerv(GL_VERTEX_ARRAY_BINDING, (GLint*)&last_vertex_array_object));
+#endif
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
+        if (bd->HasPolygonMode) { GL_CALL_COUNTED(glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode)); }
+#endif
+        GL_CALL_COUNTED(glGetIntegerv(GL_VIEWPORT, last_viewport));
+        GL_CALL_COUNTED(glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box));
+        GL_CALL_COUNTED(glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb));
+        GL_CALL_COUNTED(glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb));
+        GL_CALL_COUNTED(glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha));
+        GL_CALL_COUNTED(glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha));
+        GL_CALL_COUNTED(glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb));
+        GL_CALL_COUNTED(glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha));
+        last_enable_blend = GL_COUNTED(glIsEnabled(GL_BLEND));
+        last_enable_cull_face = GL_COUNTED(glIsEnabled(GL_CULL_FACE));
+        last_enable_depth_test = GL_COUNTED(glIsEnabled(GL_DEPTH_TEST));
+        last_enable_stencil_test = GL_COUNTED(glIsEnabled(GL_STENCIL_TEST));
+        last_enable_scissor_test = GL_COUNTED(glIsEnabled(GL_SCISSOR_TEST));
+        last_enable_primitive_restart = GL_FALSE;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
+        if (!bd->GlProfileIsES3 && bd->GlVersion >= 310)
+            last_enable_primitive_restart = GL_COUNTED(glIsEnabled(GL_PRIMITIVE_RESTART));
+#endif
+    }
+
+    void Restore(ImGui_ImplOpenGL3_Data* bd)
+    {
+        // This "glIsProgram()" check is required because if the program is "pending deletion" at the time of binding backup, it will have been deleted by now and will cause an OpenGL error. See #6220.
+        if (last_program == 0 || GL_COUNTED(glIsProgram(last_program))) GL_CALL_COUNTED(glUseProgram(last_program));
+        GL_CALL_COUNTED(glBindTexture(GL_TEXTURE_2D, last_texture));
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
+        if (bd->HasBindSampler)
+            GL_CALL_COUNTED(glBindSampler(0, last_sampler));
+#endif
+        GL_CALL_COUNTED(glActiveTexture(last_active_texture));
+#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
+        GL_CALL_COUNTED(glBindVertexArray(last_vertex_array_object));
+#endif
+        GL_CALL_COUNTED(glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer));
+#ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
+        last_vtx_attrib_state_pos.SetState(bd->AttribLocationVtxPos);
+        last_vtx_attrib_state_uv.SetState(bd->AttribLocationVtxUV);
+        last_vtx_attrib_state_color.SetState(bd->AttribLocationVtxColor);
+#endif
+        GL_CALL_COUNTED(glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha));
+        GL_CALL_COUNTED(glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha));
+        if (last_enable_blend) GL_CALL_COUNTED(glEnable(GL_BLEND)); else GL_CALL_COUNTED(glDisable(GL_BLEND));
+        if (last_enable_cull_face) GL_CALL_COUNTED(glEnable(GL_CULL_FACE)); else GL_CALL_COUNTED(glDisable(GL_CULL_FACE));
+        if (last_enable_depth_test) GL_CALL_COUNTED(glEnable(GL_DEPTH_TEST)); else GL_CALL_COUNTED(glDisable(GL_DEPTH_TEST));
+        if (last_enable_stencil_test) GL_CALL_COUNTED(glEnable(GL_STENCIL_TEST)); else GL_CALL_COUNTED(glDisable(GL_STENCIL_TEST));
+        if (last_enable_scissor_test) GL_CALL_COUNTED(glEnable(GL_SCISSOR_TEST)); else GL_CALL_COUNTED(glDisable(GL_SCISSOR_TEST));
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
+        if (!bd->GlProfileIsES3 && bd->GlVersion >= 310) { if (last_enable_primitive_restart) GL_CALL_COUNTED(glEnable(GL_PRIMITIVE_RESTART)); else GL_CALL_COUNTED(glDisable(GL_PRIMITIVE_RESTART)); }
+#endif
+
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
+        // Desktop OpenGL 3.0 and OpenGL 3.1 had separate polygon draw modes for front-facing and back-facing faces of polygons
+        if (bd->HasPolygonMode) { if (bd->GlVersion <= 310 || bd->GlProfileIsCompat) { GL_CALL_COUNTED(glPolygonMode(GL_FRONT, (GLenum)last_polygon_mode[0])); GL_CALL_COUNTED(glPolygonMode(GL_BACK, (GLenum)last_polygon_mode[1])); } else { GL_CALL_COUNTED(glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0])); } }
+#endif // IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
+
+        GL_CALL_COUNTED(glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]));
+        GL_CALL_COUNTED(glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]));
+    }
+};
+
 // OpenGL3 Render function.
 // Note that this implementation is little overcomplicated because we are saving/setting up/restoring every OpenGL state explicitly.
 // This is in order to be able to run within an OpenGL engine that doesn't do so.
@@ -537,6 +998,7 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
     ImGui_ImplOpenGL3_InitLoader(); // Lazily init loader if not already done for e.g. DLL boundaries.
 
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    bd->FrameStats.GlCalls = 0;
 
     // Catch up with texture updates. Most of the times, the list will have 1 element with an OK status, aka nothing to do.
     // (This almost always points to ImGui::GetPlatformIO().Textures[] but is part of ImDrawData to allow overriding or disabling texture updates).
@@ -545,59 +1007,61 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
             if (tex->Status != ImTextureStatus_OK)
                 ImGui_ImplOpenGL3_UpdateTexture(tex);
 
-    // Backup GL state
-    GLenum last_active_texture; glGetIntegerv(GL_ACTIVE_TEXTURE, (GLint*)&last_active_texture);
-    glActiveTexture(GL_TEXTURE0);
-    GLuint last_program; glGetIntegerv(GL_CURRENT_PROGRAM, (GLint*)&last_program);
-    GLuint last_texture; glGetIntegerv(GL_TEXTURE_BINDING_2D, (GLint*)&last_texture);
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
-    GLuint last_sampler; if (bd->HasBindSampler) { glGetIntegerv(GL_SAMPLER_BINDING, (GLint*)&last_sampler); } else { last_sampler = 0; }
-#endif
-    GLuint last_array_buffer; glGetIntegerv(GL_ARRAY_BUFFER_BINDING, (GLint*)&last_array_buffer);
-#ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    // This is part of VAO on OpenGL 3.0+ and OpenGL ES 3.0+.
-    GLint last_element_array_buffer; glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &last_element_array_buffer);
-    ImGui_ImplOpenGL3_VtxAttribState last_vtx_attrib_state_pos; last_vtx_attrib_state_pos.GetState(bd->AttribLocationVtxPos);
-    ImGui_ImplOpenGL3_VtxAttribState last_vtx_attrib_state_uv; last_vtx_attrib_state_uv.GetState(bd->AttribLocationVtxUV);
-    ImGui_ImplOpenGL3_VtxAttribState last_vtx_attrib_state_color; last_vtx_attrib_state_color.GetState(bd->AttribLocationVtxColor);
-#endif
-#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    GLuint last_vertex_array_object; glGetIntegerv(GL_VERTEX_ARRAY_BINDING, (GLint*)&last_vertex_array_object);
-#endif
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
-    GLint last_polygon_mode[2]; if (bd->HasPolygonMode) { glGetIntegerv(GL_POLYGON_MODE, last_polygon_mode); }
-#endif
-    GLint last_viewport[4]; glGetIntegerv(GL_VIEWPORT, last_viewport);
-    GLint last_scissor_box[4]; glGetIntegerv(GL_SCISSOR_BOX, last_scissor_box);
-    GLenum last_blend_src_rgb; glGetIntegerv(GL_BLEND_SRC_RGB, (GLint*)&last_blend_src_rgb);
-    GLenum last_blend_dst_rgb; glGetIntegerv(GL_BLEND_DST_RGB, (GLint*)&last_blend_dst_rgb);
-    GLenum last_blend_src_alpha; glGetIntegerv(GL_BLEND_SRC_ALPHA, (GLint*)&last_blend_src_alpha);
-    GLenum last_blend_dst_alpha; glGetIntegerv(GL_BLEND_DST_ALPHA, (GLint*)&last_blend_dst_alpha);
-    GLenum last_blend_equation_rgb; glGetIntegerv(GL_BLEND_EQUATION_RGB, (GLint*)&last_blend_equation_rgb);
-    GLenum last_blend_equation_alpha; glGetIntegerv(GL_BLEND_EQUATION_ALPHA, (GLint*)&last_blend_equation_alpha);
-    GLboolean last_enable_blend = glIsEnabled(GL_BLEND);
-    GLboolean last_enable_cull_face = glIsEnabled(GL_CULL_FACE);
-    GLboolean last_enable_depth_test = glIsEnabled(GL_DEPTH_TEST);
-    GLboolean last_enable_stencil_test = glIsEnabled(GL_STENCIL_TEST);
-    GLboolean last_enable_scissor_test = glIsEnabled(GL_SCISSOR_TEST);
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
-    GLboolean last_enable_primitive_restart = (!bd->GlProfileIsES3 && bd->GlVersion >= 310) ? glIsEnabled(GL_PRIMITIVE_RESTART) : GL_FALSE;
+    // Backup GL state, unless the host does it (see ImGui_ImplOpenGL3_SetStateBackup())
+    ImGui_ImplOpenGL3_BackupGLState backup;
+    if (bd->BackupState)
+    {
+        backup.Backup(bd);
+        ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags_All);
+    }
+
+    // Upload all vertices/indices in one go when the stream buffer is usable, otherwise each list is uploaded below
+    // - Indices are rebased on the CPU whenever the whole frame is addressable by ImDrawIdx, then all lists share one vertex base.
+    // - Otherwise glDrawElementsBaseVertex() selects each list's vertices, or as a last resort the attributes are re-pointed per list.
+    GLsizeiptr stream_vtx_offset = 0;
+    GLsizeiptr stream_idx_offset = 0;
+    const bool stream_rebase_indices = (sizeof(ImDrawIdx) == 4 || draw_data->TotalVtxCount <= 65536);
+    bd->StreamBufferActive = false;
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+    if (bd->UseStreamBuffer)
+        if (ImGui_ImplOpenGL3_UploadStreamBuffer(draw_data, stream_rebase_indices, &stream_idx_offset))
+            stream_vtx_offset = bd->StreamRing.SegmentSize * bd->StreamRing.Segment;
 #endif
+    const bool stream_shared_attribs = bd->StreamBufferActive && (stream_rebase_indices || bd->HasBaseVertex);
+    GLsizeiptr attribs_vtx_offset = 0;
 
     // Setup desired GL state
     // Recreate the VAO every time (this is to easily allow multiple GL contexts to be rendered to. VAO are not shared among GL contexts)
     // The renderer would actually work without any VAO bound, but then our VertexAttrib calls would overwrite the default one currently bound.
+    // A host that disabled the state backup renders from a single context, so there the VAO and its attributes are kept across frames.
     GLuint vertex_array_object = 0;
 #ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    GL_CALL(glGenVertexArrays(1, &vertex_array_object));
+    if (bd->BackupState)
+        GL_CALL_COUNTED(glGenVertexArrays(1, &vertex_array_object));
+    else
+    {
+        if (bd->VaoHandle == 0)
+        {
+            GL_CALL_COUNTED(glGenVertexArrays(1, &bd->VaoHandle));
+            ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags_VertexArray);
+        }
+        vertex_array_object = bd->VaoHandle;
+    }
 #endif
     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
+    if (stream_shared_attribs)
+        ImGui_ImplOpenGL3_SetupVertexAttribs(attribs_vtx_offset = stream_vtx_offset);
 
     // Will project scissor/clipping rectangles into framebuffer space
     ImVec2 clip_off = draw_data->DisplayPos;         // (0,0) unless using multi-viewports
     ImVec2 clip_scale = draw_data->FramebufferScale; // (1,1) unless using retina display which are often (2,2)
 
     // Render command lists
+    // Consecutive commands sharing texture, clip rectangle and base vertex are merged into one draw call.
+    // When every list lives in the stream buffer the merge also crosses list boundaries.
+    ImGui_ImplOpenGL3_PendingDraw pending = {};
+    GLint list_vtx_base = 0;
+    bd->FrameStats.DrawCmds = bd->FrameStats.DrawCalls = 0;
     for (const ImDrawList* draw_list : draw_data->CmdLists)
     {
         // Upload vertex/index buffers
@@ -610,25 +1074,40 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
         // - See https://github.com/ocornut/imgui/issues/4468 and please report any corruption issues.
         const GLsizeiptr vtx_buffer_size = (GLsizeiptr)draw_list->VtxBuffer.Size * (int)sizeof(ImDrawVert);
         const GLsizeiptr idx_buffer_size = (GLsizeiptr)draw_list->IdxBuffer.Size * (int)sizeof(ImDrawIdx);
-        if (bd->UseBufferSubData)
+        GLsizeiptr idx_buffer_offset = 0;
+        GLint list_base_vertex = 0;
+        if (bd->StreamBufferActive)
+        {
+            // Already uploaded. Indices are addressed with an offset, vertices either through the shared attributes or this list's own.
+            if (stream_shared_attribs)
+                list_base_vertex = stream_rebase_indices ? 0 : list_vtx_base;
+            else
+            {
+                ImGui_ImplOpenGL3_FlushDraw(&pending);
+                ImGui_ImplOpenGL3_SetupVertexAttribs(attribs_vtx_offset = stream_vtx_offset + (GLsizeiptr)list_vtx_base * (int)sizeof(ImDrawVert));
+            }
+            idx_buffer_offset = stream_idx_offset;
+            stream_idx_offset += idx_buffer_size;
+        }
+        else if (bd->UseBufferSubData)
         {
             if (bd->VertexBufferSize < vtx_buffer_size)
             {
                 bd->VertexBufferSize = vtx_buffer_size;
-                GL_CALL(glBufferData(GL_ARRAY_BUFFER, bd->VertexBufferSize, nullptr, GL_STREAM_DRAW));
+                GL_CALL_COUNTED(glBufferData(GL_ARRAY_BUFFER, bd->VertexBufferSize, nullptr, GL_STREAM_DRAW));
             }
             if (bd->IndexBufferSize < idx_buffer_size)
             {
                 bd->IndexBufferSize = idx_buffer_size;
-                GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, bd->IndexBufferSize, nullptr, GL_STREAM_DRAW));
+                GL_CALL_COUNTED(glBufferData(GL_ELEMENT_ARRAY_BUFFER, bd->IndexBufferSize, nullptr, GL_STREAM_DRAW));
             }
-            GL_CALL(glBufferSubData(GL_ARRAY_BUFFER, 0, vtx_buffer_size, (const GLvoid*)draw_list->VtxBuffer.Data));
-            GL_CALL(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, idx_buffer_size, (const GLvoid*)draw_list->IdxBuffer.Data));
+            GL_CALL_COUNTED(glBufferSubData(GL_ARRAY_BUFFER, 0, vtx_buffer_size, (const GLvoid*)draw_list->VtxBuffer.Data));
+            GL_CALL_COUNTED(glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, 0, idx_buffer_size, (const GLvoid*)draw_list->IdxBuffer.Data));
         }
         else
         {
-            GL_CALL(glBufferData(GL_ARRAY_BUFFER, vtx_buffer_size, (const GLvoid*)draw_list->VtxBuffer.Data, GL_STREAM_DRAW));
-            GL_CALL(glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx_buffer_size, (const GLvoid*)draw_list->IdxBuffer.Data, GL_STREAM_DRAW));
+            GL_CALL_COUNTED(glBufferData(GL_ARRAY_BUFFER, vtx_buffer_size, (const GLvoid*)draw_list->VtxBuffer.Data, GL_STREAM_DRAW));
+            GL_CALL_COUNTED(glBufferData(GL_ELEMENT_ARRAY_BUFFER, idx_buffer_size, (const GLvoid*)draw_list->IdxBuffer.Data, GL_STREAM_DRAW));
         }
 
         for (int cmd_i = 0; cmd_i < draw_list->CmdBuffer.Size; cmd_i++)
@@ -638,10 +1117,18 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
             {
                 // User callback, registered via ImDrawList::AddCallback()
                 // (ImDrawCallback_ResetRenderState is a special callback value used by the user to request the renderer to reset render state.)
+                ImGui_ImplOpenGL3_FlushDraw(&pending);
                 if (pcmd->UserCallback == ImDrawCallback_ResetRenderState)
+                {
                     ImGui_ImplOpenGL3_SetupRenderState(draw_data, fb_width, fb_height, vertex_array_object);
+                    if (bd->StreamBufferActive)
+                        ImGui_ImplOpenGL3_SetupVertexAttribs(attribs_vtx_offset);
+                }
                 else
+                {
                     pcmd->UserCallback(draw_list, pcmd);
+                    ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags_All); // The callback may have changed anything
+                }
             }
             else
             {
@@ -650,64 +1137,58 @@ void    ImGui_ImplOpenGL3_RenderDrawData(ImDrawData* draw_data)
                 ImVec2 clip_max((pcmd->ClipRect.z - clip_off.x) * clip_scale.x, (pcmd->ClipRect.w - clip_off.y) * clip_scale.y);
                 if (clip_max.x <= clip_min.x || clip_max.y <= clip_min.y)
                     continue;
-
-                // Apply scissor/clipping rectangle (Y is inverted in OpenGL)
-                GL_CALL(glScissor((int)clip_min.x, (int)((float)fb_height - clip_max.y), (int)(clip_max.x - clip_min.x), (int)(clip_max.y - clip_min.y)));
-
-                // Bind texture, Draw
-                GL_CALL(glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)pcmd->GetTexID()));
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_VTX_OFFSET
-                if (bd->GlVersion >= 320)
-                    GL_CALL(glDrawElementsBaseVertex(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx)), (GLint)pcmd->VtxOffset));
+                bd->FrameStats.DrawCmds++;
+
+                // Scissor/clipping rectangle (Y is inverted in OpenGL), texture and index range
+                ImGui_ImplOpenGL3_PendingDraw draw;
+                draw.Scissor[0] = (GLint)clip_min.x;
+                draw.Scissor[1] = (GLint)((float)fb_height - clip_max.y);
+                draw.Scissor[2] = (GLint)(clip_max.x - clip_min.x);
+                draw.Scissor[3] = (GLint)(clip_max.y - clip_min.y);
+                draw.TexID = (GLuint)(intptr_t)pcmd->GetTexID();
+                draw.IdxOffset = idx_buffer_offset + (GLsizeiptr)pcmd->IdxOffset * (int)sizeof(ImDrawIdx);
+                draw.ElemCount = (GLsizei)pcmd->ElemCount;
+                draw.BaseVertex = list_base_vertex + (GLint)pcmd->VtxOffset;
+                draw.UseSdf = pcmd->TexRef._TexData != nullptr && pcmd->TexRef._TexData->UseSdf;
+
+                // Extend the pending draw when this command continues it, otherwise submit it and start over
+                if (pending.ElemCount > 0 && pending.TexID == draw.TexID && pending.BaseVertex == draw.BaseVertex && memcmp(pending.Scissor, draw.Scissor, sizeof(draw.Scissor)) == 0 &&
+                    pending.IdxOffset + (GLsizeiptr)pending.ElemCount * (int)sizeof(ImDrawIdx) == draw.IdxOffset)
+                    pending.ElemCount += draw.ElemCount;
                 else
-#endif
-                GL_CALL(glDrawElements(GL_TRIANGLES, (GLsizei)pcmd->ElemCount, sizeof(ImDrawIdx) == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT, (void*)(intptr_t)(pcmd->IdxOffset * sizeof(ImDrawIdx))));
+                {
+                    ImGui_ImplOpenGL3_FlushDraw(&pending);
+                    pending = draw;
+                }
             }
         }
+
+        // Buffers get re-specified for the next list unless everything was uploaded at once
+        list_vtx_base += draw_list->VtxBuffer.Size;
+        if (!bd->StreamBufferActive)
+            ImGui_ImplOpenGL3_FlushDraw(&pending);
     }
+    ImGui_ImplOpenGL3_FlushDraw(&pending);
 
-    // Destroy the temporary VAO
-#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    GL_CALL(glDeleteVertexArrays(1, &vertex_array_object));
+    // Fence the segment we just drew from, it gets reused IMGUI_IMPL_OPENGL_STREAM_SEGMENTS frames from now
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+    if (bd->StreamBufferActive)
+    {
+        if (!ImGui_ImplOpenGL3_FenceRing(&bd->StreamRing))
+            ImGui_ImplOpenGL3_DisableStreamBuffer();
+        bd->StreamBufferActive = false;
+    }
 #endif
 
-    // Restore modified GL state
-    // This "glIsProgram()" check is required because if the program is "pending deletion" at the time of binding backup, it will have been deleted by now and will cause an OpenGL error. See #6220.
-    if (last_program == 0 || glIsProgram(last_program)) glUseProgram(last_program);
-    glBindTexture(GL_TEXTURE_2D, last_texture);
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_BIND_SAMPLER
-    if (bd->HasBindSampler)
-        glBindSampler(0, last_sampler);
-#endif
-    glActiveTexture(last_active_texture);
+    // Destroy the temporary VAO and restore modified GL state, after which nothing we cached holds anymore
+    if (bd->BackupState)
+    {
 #ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    glBindVertexArray(last_vertex_array_object);
-#endif
-    glBindBuffer(GL_ARRAY_BUFFER, last_array_buffer);
-#ifndef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, last_element_array_buffer);
-    last_vtx_attrib_state_pos.SetState(bd->AttribLocationVtxPos);
-    last_vtx_attrib_state_uv.SetState(bd->AttribLocationVtxUV);
-    last_vtx_attrib_state_color.SetState(bd->AttribLocationVtxColor);
-#endif
-    glBlendEquationSeparate(last_blend_equation_rgb, last_blend_equation_alpha);
-    glBlendFuncSeparate(last_blend_src_rgb, last_blend_dst_rgb, last_blend_src_alpha, last_blend_dst_alpha);
-    if (last_enable_blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (last_enable_cull_face) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
-    if (last_enable_depth_test) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (last_enable_stencil_test) glEnable(GL_STENCIL_TEST); else glDisable(GL_STENCIL_TEST);
-    if (last_enable_scissor_test) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_PRIMITIVE_RESTART
-    if (!bd->GlProfileIsES3 && bd->GlVersion >= 310) { if (last_enable_primitive_restart) glEnable(GL_PRIMITIVE_RESTART); else glDisable(GL_PRIMITIVE_RESTART); }
+        GL_CALL_COUNTED(glDeleteVertexArrays(1, &vertex_array_object));
 #endif
-
-#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
-    // Desktop OpenGL 3.0 and OpenGL 3.1 had separate polygon draw modes for front-facing and back-facing faces of polygons
-    if (bd->HasPolygonMode) { if (bd->GlVersion <= 310 || bd->GlProfileIsCompat) { glPolygonMode(GL_FRONT, (GLenum)last_polygon_mode[0]); glPolygonMode(GL_BACK, (GLenum)last_polygon_mode[1]); } else { glPolygonMode(GL_FRONT_AND_BACK, (GLenum)last_polygon_mode[0]); } }
-#endif // IMGUI_IMPL_OPENGL_MAY_HAVE_POLYGON_MODE
-
-    glViewport(last_viewport[0], last_viewport[1], (GLsizei)last_viewport[2], (GLsizei)last_viewport[3]);
-    glScissor(last_scissor_box[0], last_scissor_box[1], (GLsizei)last_scissor_box[2], (GLsizei)last_scissor_box[3]);
+        backup.Restore(bd);
+        ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags_All);
+    }
     (void)bd; // Not all compilation paths use this
 }
 
@@ -721,6 +1202,150 @@ static void ImGui_ImplOpenGL3_DestroyTexture(ImTextureData* tex)
     tex->SetStatus(ImTextureStatus_Destroyed);
 }
 
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+// Stop staging texture updates and copying grown textures GPU-side, upload straight from tex->Pixels instead.
+static void ImGui_ImplOpenGL3_DisableUploadBuffer()
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    ImGui_ImplOpenGL3_DestroyRing(&bd->UploadRing);
+    bd->UseUploadBuffer = false;
+#ifdef IMGUI_IMPL_OPENGL_DEBUG
+    fprintf(stderr, "Upload buffer disabled, falling back to client memory texture uploads.\n");
+#endif
+}
+
+// Pack 'rects' tightly into the next segment of the upload ring and source glTexSubImage2D() from it, so the driver
+// can return right away and copy into the texture when the GPU gets to it. Never waits: if the segment is still
+// in flight return false and let the caller upload from client memory.
+static bool ImGui_ImplOpenGL3_StageTextureRects(ImTextureData* tex, const ImVector<ImTextureRect>& rects)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    GLsizeiptr total_size = 0;
+    for (const ImTextureRect& r : rects)
+        total_size += (GLsizeiptr)r.w * r.h * tex->BytesPerPixel;
+    if (total_size == 0)
+        return true;
+
+    if (bd->UploadRing.Handle == 0)
+        GL_CALL_COUNTED(glGenBuffers(1, &bd->UploadRing.Handle));
+    GL_CALL_COUNTED(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, bd->UploadRing.Handle));
+    void* data = nullptr;
+    GLsizeiptr segment_offset = 0;
+    ImGui_ImplOpenGL3_RingResult result = ImGui_ImplOpenGL3_MapRing(&bd->UploadRing, GL_PIXEL_UNPACK_BUFFER, total_size, 0, &data, &segment_offset);
+    if (result == ImGui_ImplOpenGL3_RingResult_Ok)
+    {
+        char* dst = (char*)data;
+        for (const ImTextureRect& r : rects)
+        {
+            const int src_pitch = r.w * tex->BytesPerPixel;
+            for (int y = 0; y < r.h; y++, dst += src_pitch)
+                memcpy(dst, tex->GetPixelsAt(r.x, r.y + y), src_pitch);
+        }
+        if (GL_COUNTED(glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER)) == GL_TRUE)
+        {
+            GLsizeiptr offset = segment_offset;
+            for (const ImTextureRect& r : rects)
+            {
+                GL_CALL_COUNTED(glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.w, r.h, GL_RGBA, GL_UNSIGNED_BYTE, (const void*)(intptr_t)offset));
+                offset += (GLsizeiptr)r.w * r.h * tex->BytesPerPixel;
+            }
+            if (!ImGui_ImplOpenGL3_FenceRing(&bd->UploadRing))
+                ImGui_ImplOpenGL3_DisableUploadBuffer(); // Uploads above are already queued
+            GL_CALL_COUNTED(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+            return true;
+        }
+        result = ImGui_ImplOpenGL3_RingResult_Failed; // Storage got corrupted, contents are undefined
+    }
+    GL_CALL_COUNTED(glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0));
+    if (result == ImGui_ImplOpenGL3_RingResult_Failed)
+        ImGui_ImplOpenGL3_DisableUploadBuffer();
+    return false;
+}
+#endif
+
+// Upload 'rects' from tex->Pixels into the bound texture
+static void ImGui_ImplOpenGL3_UploadTextureRects(ImTextureData* tex, const ImVector<ImTextureRect>& rects)
+{
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+    if (ImGui_ImplOpenGL3_GetBackendData()->UseUploadBuffer && ImGui_ImplOpenGL3_StageTextureRects(tex, rects))
+        return;
+#endif
+#if GL_UNPACK_ROW_LENGTH // Not on WebGL/ES
+    GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, tex->Width));
+    for (const ImTextureRect& r : rects)
+        GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.w, r.h, GL_RGBA, GL_UNSIGNED_BYTE, tex->GetPixelsAt(r.x, r.y)));
+    GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
+#else
+    // GL ES doesn't have GL_UNPACK_ROW_LENGTH, so we need to (A) copy to a contiguous buffer or (B) upload line by line.
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    for (const ImTextureRect& r : rects)
+    {
+        const int src_pitch = r.w * tex->BytesPerPixel;
+        bd->TempBuffer.resize(r.h * src_pitch);
+        char* out_p = bd->TempBuffer.Data;
+        for (int y = 0; y < r.h; y++, out_p += src_pitch)
+            memcpy(out_p, tex->GetPixelsAt(r.x, r.y + y), src_pitch);
+        IM_ASSERT(out_p == bd->TempBuffer.end());
+        GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.w, r.h, GL_RGBA, GL_UNSIGNED_BYTE, bd->TempBuffer.Data));
+    }
+#endif
+}
+
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+// Fill a newly created texture (bound as 'gl_tex_id') from the one it replaces after the atlas grew, see ImTextureData::CopySourceTex.
+// Existing blocks are blitted GPU-side and only pixels written since the repack come from memory. Returns false to upload everything instead.
+static bool ImGui_ImplOpenGL3_CopyTextureFromSource(ImTextureData* tex, GLuint gl_tex_id)
+{
+    ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
+    ImTextureData* src_tex = tex->CopySourceTex;
+    if (!bd->UseUploadBuffer || src_tex == nullptr || src_tex->Status != ImTextureStatus_OK || src_tex->TexID == ImTextureID_Invalid || src_tex->Format != tex->Format)
+        return false;
+    GL_CALL_COUNTED(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex->Width, tex->Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr));
+
+    // Backup state touched by the clear and blits
+    GLint last_draw_framebuffer; GL_CALL_COUNTED(glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &last_draw_framebuffer));
+    GLint last_read_framebuffer; GL_CALL_COUNTED(glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &last_read_framebuffer));
+    GLboolean last_color_mask[4]; GL_CALL_COUNTED(glGetBooleanv(GL_COLOR_WRITEMASK, last_color_mask));
+    GLboolean last_enable_scissor_test = GL_COUNTED(glIsEnabled(GL_SCISSOR_TEST));
+
+    if (bd->CopyFbos[0] == 0)
+        GL_CALL_COUNTED(glGenFramebuffers(2, bd->CopyFbos));
+    GL_CALL_COUNTED(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, bd->CopyFbos[0]));
+    GL_CALL_COUNTED(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, gl_tex_id, 0));
+    GL_CALL_COUNTED(glBindFramebuffer(GL_READ_FRAMEBUFFER, bd->CopyFbos[1]));
+    GL_CALL_COUNTED(glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, (GLuint)(intptr_t)src_tex->TexID, 0));
+    const bool complete = GL_COUNTED(glCheckFramebufferStatus(GL_DRAW_FRAMEBUFFER)) == GL_FRAMEBUFFER_COMPLETE && GL_COUNTED(glCheckFramebufferStatus(GL_READ_FRAMEBUFFER)) == GL_FRAMEBUFFER_COMPLETE;
+    if (complete)
+    {
+        // Clear first: the CPU side starts zeroed and packed areas that never get written must match it
+        static const GLfloat clear_color[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+        GL_CALL_COUNTED(glDisable(GL_SCISSOR_TEST));
+        GL_CALL_COUNTED(glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE));
+        GL_CALL_COUNTED(glClearBufferfv(GL_COLOR, 0, clear_color));
+        for (const ImTextureCopyRect& r : tex->CopyRects)
+            GL_CALL_COUNTED(glBlitFramebuffer(r.src_x, r.src_y, r.src_x + r.w, r.src_y + r.h, r.dst_x, r.dst_y, r.dst_x + r.w, r.dst_y + r.h, GL_COLOR_BUFFER_BIT, GL_NEAREST));
+    }
+
+    // Detach so the framebuffers don't keep either texture alive, then restore state
+    GL_CALL_COUNTED(glFramebufferTexture2D(GL_READ_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0));
+    GL_CALL_COUNTED(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, bd->CopyFbos[0]));
+    GL_CALL_COUNTED(glFramebufferTexture2D(GL_DRAW_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, 0, 0));
+    GL_CALL_COUNTED(glBindFramebuffer(GL_DRAW_FRAMEBUFFER, last_draw_framebuffer));
+    GL_CALL_COUNTED(glBindFramebuffer(GL_READ_FRAMEBUFFER, last_read_framebuffer));
+    GL_CALL_COUNTED(glColorMask(last_color_mask[0], last_color_mask[1], last_color_mask[2], last_color_mask[3]));
+    if (last_enable_scissor_test) GL_CALL_COUNTED(glEnable(GL_SCISSOR_TEST)); else GL_CALL_COUNTED(glDisable(GL_SCISSOR_TEST));
+    if (!complete)
+    {
+        ImGui_ImplOpenGL3_DisableUploadBuffer();
+        return false;
+    }
+
+    // Glyphs rasterized after the repack
+    ImGui_ImplOpenGL3_UploadTextureRects(tex, tex->Updates);
+    return true;
+}
+#endif
+
 void ImGui_ImplOpenGL3_UpdateTexture(ImTextureData* tex)
 {
     // FIXME: Consider backing up and restoring
@@ -753,6 +1378,9 @@ void ImGui_ImplOpenGL3_UpdateTexture(ImTextureData* tex)
         GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR));
         GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE));
         GL_CALL(glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE));
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+        if (!ImGui_ImplOpenGL3_CopyTextureFromSource(tex, gl_texture_id))
+#endif
         GL_CALL(glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, tex->Width, tex->Height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels));
 
         // Store identifiers
@@ -771,25 +1399,7 @@ void ImGui_ImplOpenGL3_UpdateTexture(ImTextureData* tex)
 
         GLuint gl_tex_id = (GLuint)(intptr_t)tex->TexID;
         GL_CALL(glBindTexture(GL_TEXTURE_2D, gl_tex_id));
-#if GL_UNPACK_ROW_LENGTH // Not on WebGL/ES
-        GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, tex->Width));
-        for (ImTextureRect& r : tex->Updates)
-            GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.w, r.h, GL_RGBA, GL_UNSIGNED_BYTE, tex->GetPixelsAt(r.x, r.y)));
-        GL_CALL(glPixelStorei(GL_UNPACK_ROW_LENGTH, 0));
-#else
-        // GL ES doesn't have GL_UNPACK_ROW_LENGTH, so we need to (A) copy to a contiguous buffer or (B) upload line by line.
-        ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
-        for (ImTextureRect& r : tex->Updates)
-        {
-            const int src_pitch = r.w * tex->BytesPerPixel;
-            bd->TempBuffer.resize(r.h * src_pitch);
-            char* out_p = bd->TempBuffer.Data;
-            for (int y = 0; y < r.h; y++, out_p += src_pitch)
-                memcpy(out_p, tex->GetPixelsAt(r.x, r.y + y), src_pitch);
-            IM_ASSERT(out_p == bd->TempBuffer.end());
-            GL_CALL(glTexSubImage2D(GL_TEXTURE_2D, 0, r.x, r.y, r.w, r.h, GL_RGBA, GL_UNSIGNED_BYTE, bd->TempBuffer.Data));
-        }
-#endif
+        ImGui_ImplOpenGL3_UploadTextureRects(tex, tex->Updates);
         tex->SetStatus(ImTextureStatus_OK);
         GL_CALL(glBindTexture(GL_TEXTURE_2D, last_texture)); // Restore state
     }
@@ -914,46 +1524,81 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
         "}\n";
 
     const GLchar* fragment_shader_glsl_120 =
+        "#if defined(GL_ES) && defined(GL_OES_standard_derivatives)\n"
+        "    #extension GL_OES_standard_derivatives : enable\n"
+        "#endif\n"
         "#ifdef GL_ES\n"
         "    precision mediump float;\n"
         "#endif\n"
         "uniform sampler2D Texture;\n"
+        "uniform bool UseSdf;\n"
         "varying vec2 Frag_UV;\n"
         "varying vec4 Frag_Color;\n"
         "void main()\n"
         "{\n"
-        "    gl_FragColor = Frag_Color * texture2D(Texture, Frag_UV.st);\n"
+        "    vec4 tex = texture2D(Texture, Frag_UV.st);\n"
+        "    if (UseSdf)\n"
+        "    {\n"
+        "#if defined(GL_ES) && !defined(GL_OES_standard_derivatives)\n"
+        "        float w = 0.06;\n" // No derivatives: about one texel of smoothing, right for text drawn near its bake size
+        "#else\n"
+        "        float w = max(fwidth(tex.a) * 0.5, 0.004);\n"
+        "#endif\n"
+        "        tex.a = smoothstep(0.5 - w, 0.5 + w, tex.a);\n"
+        "    }\n"
+        "    gl_FragColor = Frag_Color * tex;\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_130 =
         "uniform sampler2D Texture;\n"
+        "uniform bool UseSdf;\n"
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 tex = texture(Texture, Frag_UV.st);\n"
+        "    if (UseSdf)\n"
+        "    {\n"
+        "        float w = max(fwidth(tex.a) * 0.5, 0.004);\n"
+        "        tex.a = smoothstep(0.5 - w, 0.5 + w, tex.a);\n"
+        "    }\n"
+        "    Out_Color = Frag_Color * tex;\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_300_es =
         "precision mediump float;\n"
         "uniform sampler2D Texture;\n"
+        "uniform bool UseSdf;\n"
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "layout (location = 0) out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 tex = texture(Texture, Frag_UV.st);\n"
+        "    if (UseSdf)\n"
+        "    {\n"
+        "        float w = max(fwidth(tex.a) * 0.5, 0.004);\n"
+        "        tex.a = smoothstep(0.5 - w, 0.5 + w, tex.a);\n"
+        "    }\n"
+        "    Out_Color = Frag_Color * tex;\n"
         "}\n";
 
     const GLchar* fragment_shader_glsl_410_core =
         "in vec2 Frag_UV;\n"
         "in vec4 Frag_Color;\n"
         "uniform sampler2D Texture;\n"
+        "uniform bool UseSdf;\n"
         "layout (location = 0) out vec4 Out_Color;\n"
         "void main()\n"
         "{\n"
-        "    Out_Color = Frag_Color * texture(Texture, Frag_UV.st);\n"
+        "    vec4 tex = texture(Texture, Frag_UV.st);\n"
+        "    if (UseSdf)\n"
+        "    {\n"
+        "        float w = max(fwidth(tex.a) * 0.5, 0.004);\n"
+        "        tex.a = smoothstep(0.5 - w, 0.5 + w, tex.a);\n"
+        "    }\n"
+        "    Out_Color = Frag_Color * tex;\n"
         "}\n";
 
     // Select shaders matching our GLSL versions
@@ -980,38 +1625,46 @@ bool    ImGui_ImplOpenGL3_CreateDeviceObjects()
         fragment_shader = fragment_shader_glsl_130;
     }
 
-    // Create shaders
-    const GLchar* vertex_shader_with_version[2] = { bd->GlslVersionString, vertex_shader };
-    GLuint vert_handle;
-    GL_CALL(vert_handle = glCreateShader(GL_VERTEX_SHADER));
-    glShaderSource(vert_handle, 2, vertex_shader_with_version, nullptr);
-    glCompileShader(vert_handle);
-    if (!CheckShader(vert_handle, "vertex shader"))
-        return false;
-
-    const GLchar* fragment_shader_with_version[2] = { bd->GlslVersionString, fragment_shader };
-    GLuint frag_handle;
-    GL_CALL(frag_handle = glCreateShader(GL_FRAGMENT_SHADER));
-    glShaderSource(frag_handle, 2, fragment_shader_with_version, nullptr);
-    glCompileShader(frag_handle);
-    if (!CheckShader(frag_handle, "fragment shader"))
-        return false;
-
-    // Link
+    // Try the program binary cache first, then compile from source
     bd->ShaderHandle = glCreateProgram();
-    glAttachShader(bd->ShaderHandle, vert_handle);
-    glAttachShader(bd->ShaderHandle, frag_handle);
-    glLinkProgram(bd->ShaderHandle);
-    if (!CheckProgram(bd->ShaderHandle, "shader program"))
-        return false;
-
-    glDetachShader(bd->ShaderHandle, vert_handle);
-    glDetachShader(bd->ShaderHandle, frag_handle);
-    glDeleteShader(vert_handle);
-    glDeleteShader(frag_handle);
+    if (bd->LoadProgramFunc == nullptr || !bd->LoadProgramFunc(bd->ShaderHandle, bd->GlslVersionString, vertex_shader, fragment_shader))
+    {
+        // Create shaders
+        const GLchar* vertex_shader_with_version[2] = { bd->GlslVersionString, vertex_shader };
+        GLuint vert_handle;
+        GL_CALL(vert_handle = glCreateShader(GL_VERTEX_SHADER));
+        glShaderSource(vert_handle, 2, vertex_shader_with_version, nullptr);
+        glCompileShader(vert_handle);
+        if (!CheckShader(vert_handle, "vertex shader"))
+            return false;
+
+        const GLchar* fragment_shader_with_version[2] = { bd->GlslVersionString, fragment_shader };
+        GLuint frag_handle;
+        GL_CALL(frag_handle = glCreateShader(GL_FRAGMENT_SHADER));
+        glShaderSource(frag_handle, 2, fragment_shader_with_version, nullptr);
+        glCompileShader(frag_handle);
+        if (!CheckShader(frag_handle, "fragment shader"))
+            return false;
+
+        // Link
+        glAttachShader(bd->ShaderHandle, vert_handle);
+        glAttachShader(bd->ShaderHandle, frag_handle);
+        glLinkProgram(bd->ShaderHandle);
+        if (!CheckProgram(bd->ShaderHandle, "shader program"))
+            return false;
+
+        glDetachShader(bd->ShaderHandle, vert_handle);
+        glDetachShader(bd->ShaderHandle, frag_handle);
+        glDeleteShader(vert_handle);
+        glDeleteShader(frag_handle);
+        if (bd->StoreProgramFunc != nullptr)
+            bd->StoreProgramFunc(bd->ShaderHandle, bd->GlslVersionString, vertex_shader, fragment_shader);
+    }
 
     bd->AttribLocationTex = glGetUniformLocation(bd->ShaderHandle, "Texture");
     bd->AttribLocationProjMtx = glGetUniformLocation(bd->ShaderHandle, "ProjMtx");
+    bd->AttribLocationUseSdf = glGetUniformLocation(bd->ShaderHandle, "UseSdf");
+    bd->CachedUseSdf = 0; // Uniforms start at zero once linked
     bd->AttribLocationVtxPos = (GLuint)glGetAttribLocation(bd->ShaderHandle, "Position");
     bd->AttribLocationVtxUV = (GLuint)glGetAttribLocation(bd->ShaderHandle, "UV");
     bd->AttribLocationVtxColor = (GLuint)glGetAttribLocation(bd->ShaderHandle, "Color");
@@ -1038,7 +1691,17 @@ void    ImGui_ImplOpenGL3_DestroyDeviceObjects()
     ImGui_ImplOpenGL3_Data* bd = ImGui_ImplOpenGL3_GetBackendData();
     if (bd->VboHandle)      { glDeleteBuffers(1, &bd->VboHandle); bd->VboHandle = 0; }
     if (bd->ElementsHandle) { glDeleteBuffers(1, &bd->ElementsHandle); bd->ElementsHandle = 0; }
+#ifdef IMGUI_IMPL_OPENGL_MAY_HAVE_STREAM_BUFFER
+    ImGui_ImplOpenGL3_DestroyStreamBuffer();
+    ImGui_ImplOpenGL3_DestroyRing(&bd->UploadRing);
+    if (bd->CopyFbos[0])    { glDeleteFramebuffers(2, bd->CopyFbos); bd->CopyFbos[0] = bd->CopyFbos[1] = 0; }
+#endif
     if (bd->ShaderHandle)   { glDeleteProgram(bd->ShaderHandle); bd->ShaderHandle = 0; }
+#ifdef IMGUI_IMPL_OPENGL_USE_VERTEX_ARRAY
+    if (bd->VaoHandle)      { glDeleteVertexArrays(1, &bd->VaoHandle); bd->VaoHandle = 0; }
+#endif
+    bd->ProjectionValid = false;
+    ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags_All);
 
     // Destroy all textures
     for (ImTextureData* tex : ImGui::GetPlatformIO().Textures)
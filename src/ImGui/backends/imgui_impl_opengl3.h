@@ -5,7 +5,7 @@
 
 // Implemented features:
 //  [X] Renderer: User texture binding. Use 'GLuint' OpenGL texture as texture identifier. Read the FAQ about ImTextureID/ImTextureRef!
-//  [x] Renderer: Large meshes support (64k+ vertices) even with 16-bit indices (ImGuiBackendFlags_RendererHasVtxOffset) [Desktop OpenGL only!]
+//  [x] Renderer: Large meshes support (64k+ vertices) even with 16-bit indices (ImGuiBackendFlags_RendererHasVtxOffset) [Desktop OpenGL 3.2+, GL ES 3.2 or OES/EXT_draw_elements_base_vertex]
 //  [X] Renderer: Texture updates support for dynamic font atlas (ImGuiBackendFlags_RendererHasTextures).
 
 // About WebGL/ES:
@@ -43,6 +43,43 @@ IMGUI_IMPL_API void     ImGui_ImplOpenGL3_DestroyDeviceObjects();
 // (Advanced) Use e.g. if you need to precisely control the timing of texture updates (e.g. for staged rendering), by setting ImDrawData::Textures = NULL to handle this manually.
 IMGUI_IMPL_API void     ImGui_ImplOpenGL3_UpdateTexture(ImTextureData* tex);
 
+// (Optional) Program binary cache, used by CreateDeviceObjects() to avoid compiling the shaders on every startup. Call after Init().
+// - load_func: return true if a cached binary was loaded into 'program' and it linked. Otherwise the backend compiles from source.
+//   It is called before the source link, so it is also the place to set link hints such as GL_PROGRAM_BINARY_RETRIEVABLE_HINT.
+// - store_func: called after a successful link from source so the binary can be saved.
+typedef bool (*ImGui_ImplOpenGL3_LoadProgramFunc)(unsigned int program, const char* glsl_version, const char* vertex_shader, const char* fragment_shader);
+typedef void (*ImGui_ImplOpenGL3_StoreProgramFunc)(unsigned int program, const char* glsl_version, const char* vertex_shader, const char* fragment_shader);
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetProgramCache(ImGui_ImplOpenGL3_LoadProgramFunc load_func, ImGui_ImplOpenGL3_StoreProgramFunc store_func);
+
+// (Optional) Counters for the last ImGui_ImplOpenGL3_RenderDrawData() call.
+struct ImGui_ImplOpenGL3_FrameStats
+{
+    int     DrawCmds;       // Visible ImDrawCmd submitted by Dear ImGui (what a naive renderer would draw)
+    int     DrawCalls;      // glDrawElements() actually issued after merging
+    int     GlCalls;        // Every GL call made by RenderDrawData(), including state backup/restore
+};
+IMGUI_IMPL_API ImGui_ImplOpenGL3_FrameStats ImGui_ImplOpenGL3_GetFrameStats();
+
+// (Optional) State cache. The backend remembers the GL state it last set and only issues what changed.
+// - By default RenderDrawData() saves and restores the host's state, so nothing carries over between frames.
+// - A host that saves/restores GL state itself, and renders from a single context, can call ImGui_ImplOpenGL3_SetStateBackup(false).
+//   The cache then persists across frames and the host must call ImGui_ImplOpenGL3_InvalidateState() for every group it changes in between.
+enum ImGui_ImplOpenGL3_StateFlags_
+{
+    ImGui_ImplOpenGL3_StateFlags_None           = 0,
+    ImGui_ImplOpenGL3_StateFlags_Blend          = 1 << 0,   // GL_BLEND, blend equation and function
+    ImGui_ImplOpenGL3_StateFlags_Capabilities   = 1 << 1,   // GL_CULL_FACE, GL_DEPTH_TEST, GL_STENCIL_TEST, GL_SCISSOR_TEST, polygon mode
+    ImGui_ImplOpenGL3_StateFlags_Viewport       = 1 << 2,
+    ImGui_ImplOpenGL3_StateFlags_Scissor        = 1 << 3,   // Scissor box
+    ImGui_ImplOpenGL3_StateFlags_Program        = 1 << 4,   // Current program (our uniforms are program state and never need invalidating)
+    ImGui_ImplOpenGL3_StateFlags_Texture        = 1 << 5,   // Active texture unit, GL_TEXTURE_2D binding and sampler on unit 0
+    ImGui_ImplOpenGL3_StateFlags_VertexArray    = 1 << 6,   // Vertex array object, GL_ARRAY_BUFFER binding
+    ImGui_ImplOpenGL3_StateFlags_All            = (1 << 7) - 1,
+};
+typedef int ImGui_ImplOpenGL3_StateFlags;
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_InvalidateState(ImGui_ImplOpenGL3_StateFlags flags = ImGui_ImplOpenGL3_StateFlags_All);
+IMGUI_IMPL_API void     ImGui_ImplOpenGL3_SetStateBackup(bool enabled);
+
 // Configuration flags to add in your imconfig file:
 //#define IMGUI_IMPL_OPENGL_ES2     // Enable ES 2 (Auto-detected on Emscripten)
 //#define IMGUI_IMPL_OPENGL_ES3     // Enable ES 3 (Auto-detected on iOS/Android)
@@ -2288,7 +2288,16 @@ void ImFormatStringToTempBufferV(const char** out_buf, const char** out_buf_end,
     }
 }
 
-#ifndef IMGUI_ENABLE_SSE4_2_CRC
+#if defined(IMGUI_ENABLE_SSE4_2_CRC)
+#define IM_CRC32_U8(crc, c)     _mm_crc32_u8(crc, c)
+#elif defined(IMGUI_ENABLE_ARM_CRC) && defined(IMGUI_USE_LEGACY_CRC32_ADLER)
+#define IM_CRC32_U8(crc, c)     __crc32b(crc, c)
+#define IM_CRC32_U64(crc, v)    __crc32d(crc, v)
+#elif defined(IMGUI_ENABLE_ARM_CRC)
+#define IM_CRC32_U8(crc, c)     __crc32cb(crc, c)
+#define IM_CRC32_U64(crc, v)    __crc32cd(crc, v)
+#else
+#define IM_CRC32_U8(crc, c)     ((crc >> 8) ^ GCrc32LookupTable[(crc & 0xFF) ^ (c)])
 // CRC32 needs a 1KB lookup table (not cache friendly)
 // Although the code to generate the table is simple and shorter than the table itself, using a const table allows us to easily:
 // - avoid an unnecessary branch/memory tap, - keep the ImHashXXX functions usable by static constructors, - make it thread-safe.
@@ -2342,23 +2351,36 @@ ImGuiID ImHashData(const void* data_p, size_t data_size, ImGuiID seed)
     ImU32 crc = ~seed;
     const unsigned char* data = (const unsigned char*)data_p;
     const unsigned char *data_end = (const unsigned char*)data_p + data_size;
-#ifndef IMGUI_ENABLE_SSE4_2_CRC
-    const ImU32* crc32_lut = GCrc32LookupTable;
-    while (data < data_end)
-        crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ *data++];
-    return ~crc;
-#else
+#if defined(IMGUI_ENABLE_SSE4_2_CRC)
     while (data + 4 <= data_end)
     {
         crc = _mm_crc32_u32(crc, *(ImU32*)data);
         data += 4;
     }
+#elif defined(IMGUI_ENABLE_ARM_CRC)
+    while (data + 8 <= data_end)
+    {
+        ImU64 v;
+        memcpy(&v, data, 8);
+        crc = IM_CRC32_U64(crc, v);
+        data += 8;
+    }
+#endif
     while (data < data_end)
-        crc = _mm_crc32_u8(crc, *data++);
+        crc = IM_CRC32_U8(crc, *data++);
     return ~crc;
-#endif
 }
 
+#ifdef IMGUI_ENABLE_ARM_CRC
+// Bytes may be hashed 8 at a time when none of them is a terminator or a '#' which could start "###"
+static inline bool ImHashStrCanHashWord(ImU64 v)
+{
+    const ImU64 ones = 0x0101010101010101ULL, highs = 0x8080808080808080ULL, hashes = 0x2323232323232323ULL;
+    const ImU64 v_hash = v ^ hashes;
+    return ((((v - ones) & ~v) | ((v_hash - ones) & ~v_hash)) & highs) == 0;
+}
+#endif
+
 // Zero-terminated string hash, with support for ### to reset back to seed value
 // We support a syntax of "label###id" where only "###id" is included in the hash, and only "label" gets displayed.
 // Because this syntax is rarely used we are optimizing for the common case.
@@ -2367,37 +2389,45 @@ ImGuiID ImHashData(const void* data_p, size_t data_size, ImGuiID seed)
 // FIXME-OPT: Replace with e.g. FNV1a hash? CRC32 pretty much randomly access 1KB. Need to do proper measurements.
 ImGuiID ImHashStr(const char* data_p, size_t data_size, ImGuiID seed)
 {
+#ifdef IMGUI_ENABLE_ARM_CRC
+    // Words are only read within a known length, so a zero-terminated string is measured first. Reading whole aligned words
+    // past the terminator can't fault, but it is still out of bounds and ASan/HWASan/MTE report it.
+    if (data_size == 0 && data_p[0] != 0)
+        data_size = strlen(data_p);
+#endif
     seed = ~seed;
     ImU32 crc = seed;
     const unsigned char* data = (const unsigned char*)data_p;
-#ifndef IMGUI_ENABLE_SSE4_2_CRC
-    const ImU32* crc32_lut = GCrc32LookupTable;
-#endif
     if (data_size != 0)
     {
         while (data_size-- != 0)
         {
+#ifdef IMGUI_ENABLE_ARM_CRC
+            ImU64 v;
+            if (data_size >= 7 && (memcpy(&v, data, 8), ImHashStrCanHashWord(v)))
+            {
+                crc = IM_CRC32_U64(crc, v);
+                data += 8;
+                data_size -= 7;
+                continue;
+            }
+#endif
             unsigned char c = *data++;
             if (c == '#' && data_size >= 2 && data[0] == '#' && data[1] == '#')
                 crc = seed;
-#ifndef IMGUI_ENABLE_SSE4_2_CRC
-            crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ c];
-#else
-            crc = _mm_crc32_u8(crc, c);
-#endif
+            crc = IM_CRC32_U8(crc, c);
         }
     }
     else
     {
-        while (unsigned char c = *data++)
+        for (;;)
         {
+            unsigned char c = *data++;
+            if (c == 0)
+                break;
             if (c == '#' && data[0] == '#' && data[1] == '#')
                 crc = seed;
-#ifndef IMGUI_ENABLE_SSE4_2_CRC
-            crc = (crc >> 8) ^ crc32_lut[(crc & 0xFF) ^ c];
-#else
-            crc = _mm_crc32_u8(crc, c);
-#endif
+            crc = IM_CRC32_U8(crc, c);
         }
     }
     return ~crc;
@@ -5384,7 +5414,7 @@ static void SetupDrawListSharedData()
     g.DrawListSharedData.InitialFlags = ImDrawListFlags_None;
     if (g.Style.AntiAliasedLines)
         g.DrawListSharedData.InitialFlags |= ImDrawListFlags_AntiAliasedLines;
-    if (g.Style.AntiAliasedLinesUseTex && !(g.IO.Fonts->Flags & ImFontAtlasFlags_NoBakedLines))
+    if (g.Style.AntiAliasedLinesUseTex && !(g.IO.Fonts->Flags & (ImFontAtlasFlags_NoBakedLines | ImFontAtlasFlags_SignedDistanceField)))
         g.DrawListSharedData.InitialFlags |= ImDrawListFlags_AntiAliasedLinesUseTex;
     if (g.Style.AntiAliasedFill)
         g.DrawListSharedData.InitialFlags |= ImDrawListFlags_AntiAliasedFill;
@@ -3461,6 +3461,14 @@ struct ImTextureRect
     unsigned short      w, h;       // Size of rectangle to update (in pixels)
 };
 
+// A block to copy from another texture, see ImTextureData::CopySourceTex.
+struct ImTextureCopyRect
+{
+    unsigned short      src_x, src_y;   // Upper-left coordinates in the source texture
+    unsigned short      dst_x, dst_y;   // Upper-left coordinates in the destination texture
+    unsigned short      w, h;
+};
+
 // Specs and pixel storage for a texture used by Dear ImGui.
 // This is only useful for (1) core library and (2) backends. End-user/applications do not need to care about this.
 // Renderer Backends will create a GPU-side version of this.
@@ -3486,7 +3494,10 @@ struct ImTextureData
     int                 UnusedFrames;           // w    r   // In order to facilitate handling Status==WantDestroy in some backend: this is a count successive frames where the texture was not used. Always >0 when Status==WantDestroy.
     unsigned short      RefCount;               // w    r   // Number of contexts using this texture. Used during backend shutdown.
     bool                UseColors;              // w    r   // Tell whether our texture data is known to use colors (rather than just white + alpha).
+    bool                UseSdf;                 // w    r   // Alpha holds signed distance fields, 0.5 being the glyph edge (ImFontAtlasFlags_SignedDistanceField). Renderer should threshold it instead of blending with it.
     bool                WantDestroyNextFrame;   // rw   -   // [Internal] Queued to set ImTextureStatus_WantDestroy next frame. May still be used in the current frame.
+    ImTextureData*      CopySourceTex;          // w    r   // When _WantCreate after the atlas grew: texture holding the same pixels at CopyRects[] source positions. A backend may copy those GPU-side, then upload Updates[] (pixels written since), instead of uploading everything. Only valid during the frame.
+    ImVector<ImTextureCopyRect> CopyRects;      // w    r   // Blocks to copy from CopySourceTex. Pixels outside of them and Updates[] are zero.
 
     // Functions
     ImTextureData()     { memset(this, 0, sizeof(*this)); Status = ImTextureStatus_Destroyed; TexID = ImTextureID_Invalid; }
@@ -3606,6 +3617,7 @@ enum ImFontAtlasFlags_
     ImFontAtlasFlags_NoPowerOfTwoHeight = 1 << 0,   // Don't round the height to next power of two
     ImFontAtlasFlags_NoMouseCursors     = 1 << 1,   // Don't build software mouse cursors into the atlas (save a little texture memory)
     ImFontAtlasFlags_NoBakedLines       = 1 << 2,   // Don't build thick line textures into the atlas (save a little texture memory, allow support for point/nearest filtering). The AntiAliasedLinesUseTex features uses them, otherwise they will be rendered using polygons (more expensive for CPU/GPU).
+    ImFontAtlasFlags_SignedDistanceField = 1 << 3,  // Rasterize glyphs as signed distance fields, once per font at its SizePixels, and draw every other size by scaling those. Renderer needs to decode them (see ImTextureData::UseSdf). Implies ImFontAtlasFlags_NoBakedLines.
 };
 
 // Load and rasterize multiple TTF/OTF fonts into a same texture. The font atlas will build a single texture holding:
@@ -84,15 +84,13 @@ Index of this file:
 #endif
 
 //-------------------------------------------------------------------------
-// [SECTION] STB libraries implementation (for stb_truetype and stb_rect_pack)
+// [SECTION] STB libraries implementation (for stb_truetype)
 //-------------------------------------------------------------------------
 
 // Compile time options:
 //#define IMGUI_STB_NAMESPACE           ImStb
 //#define IMGUI_STB_TRUETYPE_FILENAME   "my_folder/stb_truetype.h"
-//#define IMGUI_STB_RECT_PACK_FILENAME  "my_folder/stb_rect_pack.h"
 //#define IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION
-//#define IMGUI_DISABLE_STB_RECT_PACK_IMPLEMENTATION
 
 #ifdef IMGUI_STB_NAMESPACE
 namespace IMGUI_STB_NAMESPACE
@@ -120,25 +118,14 @@ namespace IMGUI_STB_NAMESPACE
 #pragma GCC diagnostic ignored "-Wimplicit-fallthrough"     // warning: this statement may fall through
 #endif
 
-#ifndef STB_RECT_PACK_IMPLEMENTATION                        // in case the user already have an implementation in the _same_ compilation unit (e.g. unity builds)
-#ifndef IMGUI_DISABLE_STB_RECT_PACK_IMPLEMENTATION          // in case the user already have an implementation in another compilation unit
-#define STBRP_STATIC
-#define STBRP_ASSERT(x)     do { IM_ASSERT(x); } while (0)
-#define STBRP_SORT          ImQsort
-#define STB_RECT_PACK_IMPLEMENTATION
-#endif
-#ifdef IMGUI_STB_RECT_PACK_FILENAME
-#include IMGUI_STB_RECT_PACK_FILENAME
-#else
-#include "imstb_rectpack.h"
-#endif
-#endif
-
 #ifdef  IMGUI_ENABLE_STB_TRUETYPE
+// stb_truetype may run on worker threads (see ImFontAtlasGlyphJobRun()): bypass ImGui::MemAlloc(), which also records into the current context.
+static void* ImFontAtlasGlyphJobAlloc(size_t size)  { ImGuiMemAllocFunc alloc_func; ImGuiMemFreeFunc free_func; void* user_data; ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &user_data); return alloc_func(size, user_data); }
+static void  ImFontAtlasGlyphJobFree(void* ptr)     { ImGuiMemAllocFunc alloc_func; ImGuiMemFreeFunc free_func; void* user_data; ImGui::GetAllocatorFunctions(&alloc_func, &free_func, &user_data); free_func(ptr, user_data); }
 #ifndef STB_TRUETYPE_IMPLEMENTATION                         // in case the user already have an implementation in the _same_ compilation unit (e.g. unity builds)
 #ifndef IMGUI_DISABLE_STB_TRUETYPE_IMPLEMENTATION           // in case the user already have an implementation in another compilation unit
-#define STBTT_malloc(x,u)   ((void)(u), IM_ALLOC(x))
-#define STBTT_free(x,u)     ((void)(u), IM_FREE(x))
+#define STBTT_malloc(x,u)   ((void)(u), ImFontAtlasGlyphJobAlloc(x))
+#define STBTT_free(x,u)     ((void)(u), ImFontAtlasGlyphJobFree(x))
 #define STBTT_assert(x)     do { IM_ASSERT(x); } while(0)
 #define STBTT_fmod(x,y)     ImFmod(x,y)
 #define STBTT_sqrt(x)       ImSqrt(x)
@@ -827,7 +814,7 @@ void ImDrawList::AddPolyline(const ImVec2* points, const int points_count, ImU32
         const bool use_texture = (Flags & ImDrawListFlags_AntiAliasedLinesUseTex) && (integer_thickness < IM_DRAWLIST_TEX_LINES_WIDTH_MAX) && (fractional_thickness <= 0.00001f) && (AA_SIZE == 1.0f);
 
         // We should never hit this, because NewFrame() doesn't set ImDrawListFlags_AntiAliasedLinesUseTex unless ImFontAtlasFlags_NoBakedLines is off
-        IM_ASSERT_PARANOID(!use_texture || !(_Data->Font->OwnerAtlas->Flags & ImFontAtlasFlags_NoBakedLines));
+        IM_ASSERT_PARANOID(!use_texture || !(_Data->Font->OwnerAtlas->Flags & (ImFontAtlasFlags_NoBakedLines | ImFontAtlasFlags_SignedDistanceField)));
 
         const int idx_count = use_texture ? (count * 6) : (thick_line ? count * 18 : count * 12);
         const int vtx_count = use_texture ? (points_count * 2) : (thick_line ? points_count * 4 : points_count * 3);
@@ -2790,6 +2777,13 @@ void ImFontAtlasUpdateNewFrame(ImFontAtlas* atlas, int frame_count, bool rendere
     {
         ImTextureData* tex = atlas->TexList[tex_n];
         bool remove_from_list = false;
+
+        // Copy hints only hold for the frame the texture grew in: the source is destroyed next
+        if (tex->CopySourceTex != NULL)
+        {
+            tex->CopySourceTex = NULL;
+            tex->CopyRects.clear();
+        }
         if (tex->Status == ImTextureStatus_OK)
         {
             tex->Updates.resize(0);
@@ -2972,7 +2966,9 @@ void ImFontAtlasTextureBlockQueueUpload(ImFontAtlas* atlas, ImTextureData* tex,
     tex->UsedRect.h = (unsigned short)(ImMax(tex->UsedRect.y + tex->UsedRect.h, req.y + req.h) - tex->UsedRect.y);
     atlas->TexIsBuilt = false;
 
-    // No need to queue if status is == ImTextureStatus_WantCreate
+    // No need to queue if status is == ImTextureStatus_WantCreate, unless the backend may create it by copying from CopySourceTex
+    if (tex->Status == ImTextureStatus_WantCreate && tex->CopySourceTex != NULL)
+        tex->Updates.push_back(req);
     if (tex->Status == ImTextureStatus_OK || tex->Status == ImTextureStatus_WantUpdates)
     {
         tex->Status = ImTextureStatus_WantUpdates;
@@ -3523,7 +3519,7 @@ static void ImFontAtlasBuildUpdateBasicTexData(ImFontAtlas* atlas)
 
 static void ImFontAtlasBuildUpdateLinesTexData(ImFontAtlas* atlas)
 {
-    if (atlas->Flags & ImFontAtlasFlags_NoBakedLines)
+    if (atlas->Flags & (ImFontAtlasFlags_NoBakedLines | ImFontAtlasFlags_SignedDistanceField)) // Coverage ramps would be thresholded as distances
         return;
 
     // Pack and store identifier so we can refresh UV coordinates on texture resize.
@@ -3995,6 +3991,7 @@ ImTextureData* ImFontAtlasTextureAdd(ImFontAtlas* atlas, int w, int h)
     }
 
     new_tex->Create(atlas->TexDesiredFormat, w, h);
+    new_tex->UseSdf = (atlas->Flags & ImFontAtlasFlags_SignedDistanceField) != 0;
     atlas->TexIsBuilt = false;
 
     ImFontAtlasBuildSetTexture(atlas, new_tex);
@@ -4022,6 +4019,8 @@ void ImFontAtlasTextureRepack(ImFontAtlas* atlas, int w, int h)
     ImTextureData* old_tex = atlas->TexData;
     ImTextureData* new_tex = ImFontAtlasTextureAdd(atlas, w, h);
     new_tex->UseColors = old_tex->UseColors;
+    if (old_tex->Status == ImTextureStatus_OK || old_tex->Status == ImTextureStatus_WantUpdates)
+        new_tex->CopySourceTex = old_tex; // Old pixels are (or will be, this frame) on the GPU: let the backend copy them there
     IMGUI_DEBUG_LOG_FONT("[font] Texture #%03d: resize+repack %dx%d => Texture #%03d: %dx%d\n", old_tex->UniqueID, old_tex->Width, old_tex->Height, new_tex->UniqueID, new_tex->Width, new_tex->Height);
     //for (int baked_n = 0; baked_n < builder->BakedPool.Size; baked_n++)
     //    IMGUI_DEBUG_LOG_FONT("[font] - Baked %.2fpx, %d glyphs, want_destroy=%d\n", builder->BakedPool[baked_n].FontSize, builder->BakedPool[baked_n].Glyphs.Size, builder->BakedPool[baked_n].WantDestroy);
@@ -4060,6 +4059,11 @@ void ImFontAtlasTextureRepack(ImFontAtlas* atlas, int w, int h)
         IM_ASSERT(ImFontAtlasRectId_GetIndex(new_r_id) == builder->RectsIndex.index_from_ptr(&index_entry));
         ImTextureRect* new_r = ImFontAtlasPackGetRect(atlas, new_r_id);
         ImFontAtlasTextureBlockCopy(old_tex, old_r.x, old_r.y, new_tex, new_r->x, new_r->y, new_r->w, new_r->h);
+        if (new_tex->CopySourceTex != NULL)
+        {
+            ImTextureCopyRect copy = { old_r.x, old_r.y, new_r->x, new_r->y, new_r->w, new_r->h };
+            new_tex->CopyRects.push_back(copy);
+        }
     }
     IM_ASSERT(old_rects.Size == builder->Rects.Size + builder->RectsDiscardedCount);
     builder->RectsDiscardedCount = 0;
@@ -4215,8 +4219,8 @@ void ImFontAtlasBuildInit(ImFontAtlas* atlas)
 #endif
     }
 
-    // Create initial texture size
-    if (atlas->TexData == NULL || atlas->TexData->Pixels == NULL)
+    // Create initial texture size (also when toggling ImFontAtlasFlags_SignedDistanceField, as glyphs can't be mixed)
+    if (atlas->TexData == NULL || atlas->TexData->Pixels == NULL || atlas->TexData->UseSdf != ((atlas->Flags & ImFontAtlasFlags_SignedDistanceField) != 0))
         ImFontAtlasTextureAdd(atlas, ImUpperPowerOfTwo(atlas->TexMinWidth), ImUpperPowerOfTwo(atlas->TexMinHeight));
 
     atlas->Builder = IM_NEW(ImFontAtlasBuilder)();
@@ -4259,11 +4263,12 @@ void ImFontAtlasPackInit(ImFontAtlas * atlas)
     ImTextureData* tex = atlas->TexData;
     ImFontAtlasBuilder* builder = atlas->Builder;
 
-    // In theory we could decide to reduce the number of nodes, e.g. halve them, and waste a little texture space, but it doesn't seem worth it.
-    const int pack_node_count = tex->Width / 2;
-    builder->PackNodes.resize(pack_node_count);
-    IM_STATIC_ASSERT(sizeof(stbrp_context) <= sizeof(stbrp_context_opaque));
-    stbrp_init_target((stbrp_context*)(void*)&builder->PackContext, tex->Width, tex->Height, builder->PackNodes.Data, builder->PackNodes.Size);
+    IM_ASSERT(tex->Width <= 0xFFFF && tex->Height <= 0xFFFF);
+    builder->PackSize = ImVec2i(tex->Width, tex->Height);
+    builder->PackSkyline.resize(1);
+    builder->PackSkyline[0].X = builder->PackSkyline[0].Y = 0;
+    for (ImVector<ImTextureRect>& holes : builder->PackHoles)
+        holes.resize(0);
     builder->RectsPackedSurface = builder->RectsPackedCount = 0;
     builder->MaxRectSize = ImVec2i(0, 0);
     builder->MaxRectBounds = ImVec2i(0, 0);
@@ -4303,7 +4308,32 @@ static ImFontAtlasRectId ImFontAtlasPackReuseRectEntry(ImFontAtlas* atlas, ImFon
     return ImFontAtlasRectId_Make(index_idx, index_entry->Generation);
 }
 
-// This is expected to be called in batches and followed by a repack
+static int ImFontAtlasPackGetHoleClass(int h)
+{
+    int class_n = 0;
+    while (class_n < IM_FONTATLAS_PACK_HOLE_CLASSES - 1 && (2 << class_n) <= h)
+        class_n++;
+    return class_n;
+}
+
+static void ImFontAtlasPackAddHole(ImFontAtlasBuilder* builder, const ImTextureRect& hole)
+{
+    if (hole.w < IM_FONTATLAS_PACK_HOLE_MIN_SIZE || hole.h < IM_FONTATLAS_PACK_HOLE_MIN_SIZE)
+        return;
+    ImVector<ImTextureRect>& holes = builder->PackHoles[ImFontAtlasPackGetHoleClass(hole.h)];
+    int lo = 0, hi = holes.Size;
+    while (lo < hi)
+    {
+        const int mid = (lo + hi) >> 1;
+        if (holes.Data[mid].w < hole.w)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    holes.insert(holes.Data + lo, hole);
+}
+
+// Discarded space is reused by following ImFontAtlasPackAddRect() calls, a repack reclaims the rest
 void ImFontAtlasPackDiscardRect(ImFontAtlas* atlas, ImFontAtlasRectId id)
 {
     IM_ASSERT(id != ImFontAtlasRectId_Invalid);
@@ -4326,9 +4356,92 @@ void ImFontAtlasPackDiscardRect(ImFontAtlas* atlas, ImFontAtlasRectId id)
     builder->RectsIndexFreeListStart = index_idx;
     builder->RectsDiscardedCount++;
     builder->RectsDiscardedSurface += (rect->w + pack_padding) * (rect->h + pack_padding);
+    ImTextureRect hole = { rect->x, rect->y, (unsigned short)(rect->w + pack_padding), (unsigned short)(rect->h + pack_padding) };
+    ImFontAtlasPackAddHole(builder, hole);
     rect->w = rect->h = 0; // Clear rectangle so it won't be packed again
 }
 
+// Reuse the smallest fitting hole, searching height classes upward. Within a class, holes are sorted by width.
+static bool ImFontAtlasPackFindHole(ImFontAtlasBuilder* builder, int w, int h, ImTextureRect* out_hole)
+{
+    for (int class_n = ImFontAtlasPackGetHoleClass(h); class_n < IM_FONTATLAS_PACK_HOLE_CLASSES; class_n++)
+    {
+        ImVector<ImTextureRect>& holes = builder->PackHoles[class_n];
+        int lo = 0, hi = holes.Size;
+        while (lo < hi)
+        {
+            const int mid = (lo + hi) >> 1;
+            if (holes.Data[mid].w < w)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        for (int n = lo; n < holes.Size; n++)
+            if (holes.Data[n].h >= h)
+            {
+                *out_hole = holes.Data[n];
+                holes.erase(holes.Data + n);
+                return true;
+            }
+    }
+    return false;
+}
+
+// Bottom-left: lowest Y the rectangle can sit at along the skyline, leftmost on ties.
+// This is a linear walk over the skyline nodes; only the scan under each candidate stops early, as soon as it cannot beat the best Y.
+static bool ImFontAtlasPackFindSkyline(ImFontAtlasBuilder* builder, int w, int h, int* out_node_idx, int* out_y)
+{
+    const ImFontAtlasSkylineNode* nodes = builder->PackSkyline.Data;
+    const int nodes_count = builder->PackSkyline.Size;
+    int best_node_idx = -1;
+    int best_y = builder->PackSize.y - h + 1;
+    for (int node_n = 0; node_n < nodes_count && nodes[node_n].X + w <= builder->PackSize.x; node_n++)
+    {
+        int y = nodes[node_n].Y;
+        for (int next_n = node_n + 1; next_n < nodes_count && nodes[next_n].X < nodes[node_n].X + w && y < best_y; next_n++)
+            y = ImMax(y, (int)nodes[next_n].Y);
+        if (y < best_y)
+        {
+            best_y = y;
+            best_node_idx = node_n;
+        }
+    }
+    *out_node_idx = best_node_idx;
+    *out_y = best_y;
+    return best_node_idx != -1;
+}
+
+// Raise the skyline under a rectangle placed at nodes[node_idx].X
+static void ImFontAtlasPackRaiseSkyline(ImFontAtlasBuilder* builder, int node_idx, int w, int top_y)
+{
+    ImVector<ImFontAtlasSkylineNode>& nodes = builder->PackSkyline;
+    const int x = nodes[node_idx].X;
+    const int x_end = x + w;
+
+    // Nodes [node_idx, covered_end) are under the rectangle. The last one may continue past it: keep that part as a node.
+    int covered_end = node_idx + 1;
+    while (covered_end < nodes.Size && nodes[covered_end].X < x_end)
+        covered_end++;
+    const int next_x = (covered_end < nodes.Size) ? nodes[covered_end].X : builder->PackSize.x;
+    if (x_end < next_x)
+    {
+        ImFontAtlasSkylineNode tail = { (unsigned short)x_end, nodes[covered_end - 1].Y };
+        if (covered_end - 1 == node_idx)
+            nodes.insert(nodes.Data + covered_end, tail);
+        else
+            nodes[--covered_end] = tail;
+    }
+    nodes[node_idx].Y = (unsigned short)top_y;
+    if (covered_end > node_idx + 1)
+        nodes.erase(nodes.Data + node_idx + 1, nodes.Data + covered_end);
+
+    // Merge with neighbors at the same height
+    if (node_idx + 1 < nodes.Size && nodes[node_idx + 1].Y == top_y)
+        nodes.erase(nodes.Data + node_idx + 1);
+    if (node_idx > 0 && nodes[node_idx - 1].Y == top_y)
+        nodes.erase(nodes.Data + node_idx);
+}
+
 // Important: Calling this may recreate a new texture and therefore change atlas->TexData
 // FIXME-NEWFONTS: Expose other glyph padding settings for custom alteration (e.g. drop shadows). See #7962
 ImFontAtlasRectId ImFontAtlasPackAddRect(ImFontAtlas* atlas, int w, int h, ImFontAtlasRectEntry* overwrite_entry)
@@ -4343,17 +4456,38 @@ ImFontAtlasRectId ImFontAtlasPackAddRect(ImFontAtlas* atlas, int w, int h, ImFon
 
     // Pack
     ImTextureRect r = { 0, 0, (unsigned short)w, (unsigned short)h };
+    const int pack_w = w + pack_padding;
+    const int pack_h = h + pack_padding;
     for (int attempts_remaining = 3; attempts_remaining >= 0; attempts_remaining--)
     {
+        // Try reusing space from discarded rectangles, split leftovers along the shorter axis
+        ImTextureRect hole;
+        if (ImFontAtlasPackFindHole(builder, pack_w, pack_h, &hole))
+        {
+            const bool split_h = (hole.w - pack_w) < (hole.h - pack_h);
+            ImTextureRect right = { (unsigned short)(hole.x + pack_w), hole.y, (unsigned short)(hole.w - pack_w), (unsigned short)(split_h ? pack_h : hole.h) };
+            ImTextureRect below = { hole.x, (unsigned short)(hole.y + pack_h), (unsigned short)(split_h ? hole.w : pack_w), (unsigned short)(hole.h - pack_h) };
+            ImFontAtlasPackAddHole(builder, right);
+            ImFontAtlasPackAddHole(builder, below);
+            builder->RectsDiscardedSurface = ImMax(builder->RectsDiscardedSurface - pack_w * pack_h, 0);
+
+            // Clear previous contents, including padding which won't be written by the caller
+            r.x = hole.x;
+            r.y = hole.y;
+            ImFontAtlasTextureBlockFill(atlas->TexData, r.x, r.y, pack_w, pack_h, IM_COL32_BLACK_TRANS);
+            ImFontAtlasTextureBlockQueueUpload(atlas, atlas->TexData, r.x, r.y, pack_w, pack_h);
+            break;
+        }
+
         // Try packing
-        stbrp_rect pack_r = {};
-        pack_r.w = w + pack_padding;
-        pack_r.h = h + pack_padding;
-        stbrp_pack_rects((stbrp_context*)(void*)&builder->PackContext, &pack_r, 1);
-        r.x = (unsigned short)pack_r.x;
-        r.y = (unsigned short)pack_r.y;
-        if (pack_r.was_packed)
+        int node_idx, y;
+        if (ImFontAtlasPackFindSkyline(builder, pack_w, pack_h, &node_idx, &y))
+        {
+            r.x = builder->PackSkyline[node_idx].X;
+            r.y = (unsigned short)y;
+            ImFontAtlasPackRaiseSkyline(builder, node_idx, pack_w, y + pack_h);
             break;
+        }
 
         // If we ran out of attempts, return fallback
         if (attempts_remaining == 0 || builder->LockDisableResize)
@@ -4649,22 +4783,23 @@ static bool ImGui_ImplStbTrueType_FontBakedInit(ImFontAtlas* atlas, ImFontConfig
     return true;
 }
 
-static bool ImGui_ImplStbTrueType_FontBakedLoadGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void*, ImWchar codepoint, ImFontGlyph* out_glyph, float* out_advance_x)
+// Rasterize a glyph without touching the atlas, so it may run on any thread.
+static bool ImGui_ImplStbTrueType_RasterizeGlyph(ImFontGlyphJob* job)
 {
-    // Search for first font which has the glyph
+    ImFontConfig* src = job->Src;
     ImGui_ImplStbTrueType_FontSrcData* bd_font_data = (ImGui_ImplStbTrueType_FontSrcData*)src->FontLoaderData;
     IM_ASSERT(bd_font_data);
-    int glyph_index = stbtt_FindGlyphIndex(&bd_font_data->FontInfo, (int)codepoint);
+    int glyph_index = stbtt_FindGlyphIndex(&bd_font_data->FontInfo, (int)job->LoaderCodepoint);
     if (glyph_index == 0)
         return false;
 
     // Fonts unit to pixels
-    int oversample_h, oversample_v;
-    ImFontAtlasBuildGetOversampleFactors(src, baked, &oversample_h, &oversample_v);
-    const float scale_for_layout = bd_font_data->ScaleFactor * baked->Size;
-    const float rasterizer_density = src->RasterizerDensity * baked->RasterizerDensity;
-    const float scale_for_raster_x = bd_font_data->ScaleFactor * baked->Size * rasterizer_density * oversample_h;
-    const float scale_for_raster_y = bd_font_data->ScaleFactor * baked->Size * rasterizer_density * oversample_v;
+    const int oversample_h = job->OversampleH;
+    const int oversample_v = job->OversampleV;
+    const float scale_for_layout = bd_font_data->ScaleFactor * job->Size;
+    const float rasterizer_density = src->RasterizerDensity * job->RasterizerDensity;
+    const float scale_for_raster_x = bd_font_data->ScaleFactor * job->Size * rasterizer_density * oversample_h;
+    const float scale_for_raster_y = bd_font_data->ScaleFactor * job->Size * rasterizer_density * oversample_v;
 
     // Obtain size and advance
     int x0, y0, x1, y1;
@@ -4672,39 +4807,49 @@ static bool ImGui_ImplStbTrueType_FontBakedLoadGlyph(ImFontAtlas* atlas, ImFontC
     stbtt_GetGlyphBitmapBoxSubpixel(&bd_font_data->FontInfo, glyph_index, scale_for_raster_x, scale_for_raster_y, 0, 0, &x0, &y0, &x1, &y1);
     stbtt_GetGlyphHMetrics(&bd_font_data->FontInfo, glyph_index, &advance, &lsb);
 
-    // Load metrics only mode
-    if (out_advance_x != NULL)
-    {
-        IM_ASSERT(out_glyph == NULL);
-        *out_advance_x = advance * scale_for_layout;
-        return true;
-    }
-
     // Prepare glyph
-    out_glyph->Codepoint = codepoint;
+    ImFontGlyph* out_glyph = &job->Glyph;
+    out_glyph->Codepoint = job->LoaderCodepoint;
     out_glyph->AdvanceX = advance * scale_for_layout;
 
-    // Pack and retrieve position inside texture atlas
+    const float ref_size = job->RefSize;
+    const float offsets_scale = (ref_size != 0.0f) ? (job->Size / ref_size) : 1.0f;
+    float font_off_x = (src->GlyphOffset.x * offsets_scale);
+    float font_off_y = (src->GlyphOffset.y * offsets_scale);
+    if (src->PixelSnapH) // Snap scaled offset. This is to mitigate backward compatibility issues for GlyphOffset, but a better design would be welcome.
+        font_off_x = IM_ROUND(font_off_x);
+    if (src->PixelSnapV)
+        font_off_y = IM_ROUND(font_off_y);
+
+    // Signed distance field: rendered once at layout scale (no oversampling/density), with IMGUI_FONT_SDF_PADDING texels around the outline.
+    // 128 is the edge and each texel of distance is worth 128/IMGUI_FONT_SDF_PADDING, so the renderer can find the edge at any scale.
+    if (job->Sdf)
+    {
+        int w = 0, h = 0, xoff = 0, yoff = 0;
+        unsigned char* sdf_pixels = stbtt_GetGlyphSDF(&bd_font_data->FontInfo, scale_for_layout, glyph_index, IMGUI_FONT_SDF_PADDING, 128, 128.0f / IMGUI_FONT_SDF_PADDING, &w, &h, &xoff, &yoff);
+        if (sdf_pixels == NULL)
+            return true; // Blank glyph
+        out_glyph->X0 = xoff + font_off_x;
+        out_glyph->Y0 = yoff + font_off_y + IM_ROUND(job->Ascent);
+        out_glyph->X1 = out_glyph->X0 + w;
+        out_glyph->Y1 = out_glyph->Y0 + h;
+        out_glyph->Visible = true;
+        job->Width = w;
+        job->Height = h;
+        job->Pixels = sdf_pixels; // Allocated with STBTT_malloc()
+        return true;
+    }
+
     // (generally based on stbtt_PackFontRangesRenderIntoRects)
     const bool is_visible = (x0 != x1 && y0 != y1);
     if (is_visible)
     {
         const int w = (x1 - x0 + oversample_h - 1);
         const int h = (y1 - y0 + oversample_v - 1);
-        ImFontAtlasRectId pack_id = ImFontAtlasPackAddRect(atlas, w, h);
-        if (pack_id == ImFontAtlasRectId_Invalid)
-        {
-            // Pathological out of memory case (TexMaxWidth/TexMaxHeight set too small?)
-            IM_ASSERT(pack_id != ImFontAtlasRectId_Invalid && "Out of texture memory.");
-            return false;
-        }
-        ImTextureRect* r = ImFontAtlasPackGetRect(atlas, pack_id);
 
         // Render
         stbtt_GetGlyphBitmapBox(&bd_font_data->FontInfo, glyph_index, scale_for_raster_x, scale_for_raster_y, &x0, &y0, &x1, &y1);
-        ImFontAtlasBuilder* builder = atlas->Builder;
-        builder->TempBuffer.resize(w * h * 1);
-        unsigned char* bitmap_pixels = builder->TempBuffer.Data;
+        unsigned char* bitmap_pixels = (unsigned char*)ImFontAtlasGlyphJobAlloc(w * h * 1);
         memset(bitmap_pixels, 0, w * h * 1);
 
         // Render with oversampling
@@ -4713,34 +4858,95 @@ static bool ImGui_ImplStbTrueType_FontBakedLoadGlyph(ImFontAtlas* atlas, ImFontC
         stbtt_MakeGlyphBitmapSubpixelPrefilter(&bd_font_data->FontInfo, bitmap_pixels, w, h, w,
             scale_for_raster_x, scale_for_raster_y, 0, 0, oversample_h, oversample_v, &sub_x, &sub_y, glyph_index);
 
-        const float ref_size = baked->OwnerFont->Sources[0]->SizePixels;
-        const float offsets_scale = (ref_size != 0.0f) ? (baked->Size / ref_size) : 1.0f;
-        float font_off_x = (src->GlyphOffset.x * offsets_scale);
-        float font_off_y = (src->GlyphOffset.y * offsets_scale);
-        if (src->PixelSnapH) // Snap scaled offset. This is to mitigate backward compatibility issues for GlyphOffset, but a better design would be welcome.
-            font_off_x = IM_ROUND(font_off_x);
-        if (src->PixelSnapV)
-            font_off_y = IM_ROUND(font_off_y);
         font_off_x += sub_x;
-        font_off_y += sub_y + IM_ROUND(baked->Ascent);
+        font_off_y += sub_y + IM_ROUND(job->Ascent);
         float recip_h = 1.0f / (oversample_h * rasterizer_density);
         float recip_v = 1.0f / (oversample_v * rasterizer_density);
 
         // Register glyph
-        // r->x r->y are coordinates inside texture (in pixels)
         // glyph.X0, glyph.Y0 are drawing coordinates from base text position, and accounting for oversampling.
         out_glyph->X0 = x0 * recip_h + font_off_x;
         out_glyph->Y0 = y0 * recip_v + font_off_y;
-        out_glyph->X1 = (x0 + (int)r->w) * recip_h + font_off_x;
-        out_glyph->Y1 = (y0 + (int)r->h) * recip_v + font_off_y;
+        out_glyph->X1 = (x0 + w) * recip_h + font_off_x;
+        out_glyph->Y1 = (y0 + h) * recip_v + font_off_y;
         out_glyph->Visible = true;
-        out_glyph->PackId = pack_id;
-        ImFontAtlasBakedSetFontGlyphBitmap(atlas, baked, src, out_glyph, r, bitmap_pixels, ImTextureFormat_Alpha8, w);
+        job->Width = w;
+        job->Height = h;
+        job->Pixels = bitmap_pixels;
     }
 
     return true;
 }
 
+static void ImFontAtlasGlyphJobInit(ImFontGlyphJob* job, ImFontConfig* src, int src_idx, ImFontBaked* baked, ImWchar codepoint, ImWchar loader_codepoint)
+{
+    job->Src = src;
+    job->SrcIdx = src_idx;
+    job->BakedId = baked->BakedId;
+    job->Codepoint = codepoint;
+    job->LoaderCodepoint = loader_codepoint;
+    job->Sdf = (baked->OwnerFont->OwnerAtlas->Flags & ImFontAtlasFlags_SignedDistanceField) != 0;
+    job->Size = baked->Size;
+    job->RasterizerDensity = baked->RasterizerDensity;
+    ImFontAtlasBuildGetOversampleFactors(src, baked, &job->OversampleH, &job->OversampleV);
+    job->Ascent = baked->Ascent;
+    job->RefSize = baked->OwnerFont->Sources[0]->SizePixels;
+    job->Loaded = false;
+    job->Width = job->Height = 0;
+    job->Pixels = NULL;
+}
+
+// Pack rasterized pixels and write them into the atlas texture
+static bool ImFontAtlasGlyphJobPack(ImFontAtlas* atlas, ImFontBaked* baked, ImFontGlyphJob* job, ImFontGlyph* out_glyph)
+{
+    *out_glyph = job->Glyph;
+    if (job->Pixels == NULL)
+        return true;
+    ImFontAtlasRectId pack_id = ImFontAtlasPackAddRect(atlas, job->Width, job->Height);
+    if (pack_id == ImFontAtlasRectId_Invalid)
+    {
+        // Pathological out of memory case (TexMaxWidth/TexMaxHeight set too small?)
+        IM_ASSERT(pack_id != ImFontAtlasRectId_Invalid && "Out of texture memory.");
+        return false;
+    }
+    ImTextureRect* r = ImFontAtlasPackGetRect(atlas, pack_id);
+    out_glyph->PackId = pack_id;
+    ImFontAtlasBakedSetFontGlyphBitmap(atlas, baked, job->Src, out_glyph, r, job->Pixels, ImTextureFormat_Alpha8, job->Width);
+    return true;
+}
+
+static void ImFontAtlasGlyphJobFreePixels(ImFontGlyphJob* job)
+{
+    ImFontAtlasGlyphJobFree(job->Pixels);
+    job->Pixels = NULL;
+}
+
+static bool ImGui_ImplStbTrueType_FontBakedLoadGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void*, ImWchar codepoint, ImFontGlyph* out_glyph, float* out_advance_x)
+{
+    // Load metrics only mode
+    if (out_advance_x != NULL)
+    {
+        IM_ASSERT(out_glyph == NULL);
+        ImGui_ImplStbTrueType_FontSrcData* bd_font_data = (ImGui_ImplStbTrueType_FontSrcData*)src->FontLoaderData;
+        IM_ASSERT(bd_font_data);
+        int glyph_index = stbtt_FindGlyphIndex(&bd_font_data->FontInfo, (int)codepoint);
+        if (glyph_index == 0)
+            return false;
+        const float scale_for_layout = bd_font_data->ScaleFactor * baked->Size;
+        int advance, lsb;
+        stbtt_GetGlyphHMetrics(&bd_font_data->FontInfo, glyph_index, &advance, &lsb);
+        *out_advance_x = advance * scale_for_layout;
+        return true;
+    }
+
+    // Same path as ImFontAtlasGlyphJobRun() + ImFontAtlasGlyphJobsCommit(), done right away
+    ImFontGlyphJob job;
+    ImFontAtlasGlyphJobInit(&job, src, 0, baked, codepoint, codepoint);
+    bool ret = ImGui_ImplStbTrueType_RasterizeGlyph(&job) && ImFontAtlasGlyphJobPack(atlas, baked, &job, out_glyph);
+    ImFontAtlasGlyphJobFreePixels(&job);
+    return ret;
+}
+
 const ImFontLoader* ImFontAtlasGetFontLoaderForStbTruetype()
 {
     static ImFontLoader loader;
@@ -4754,6 +4960,105 @@ const ImFontLoader* ImFontAtlasGetFontLoaderForStbTruetype()
     return &loader;
 }
 
+// Queued glyphs are marked as not found so they draw as the fallback glyph, commit replaces them.
+int ImFontAtlasGlyphJobsQueue(ImFontAtlas* atlas, ImFontBaked* baked, const ImWchar* ranges, ImVector<ImFontGlyphJob>* jobs)
+{
+    ImFont* font = baked->OwnerFont;
+    IM_ASSERT(font->OwnerAtlas == atlas);
+    if (atlas->Locked || (font->Flags & ImFontFlags_NoLoadGlyphs) || baked->LoadNoFallback)
+        return 0;
+    if (baked->Size >= IMGUI_FONT_SIZE_THRESHOLD_FOR_LOADADVANCEXONLYMODE || baked->LoadNoRenderOnLayout)
+        return 0; // Glyphs are only rasterized once drawn in this mode
+    if (baked->FallbackGlyphIndex == -1)
+        ImFontAtlasBuildSetupFontBakedFallback(baked);
+
+    const int jobs_count = jobs->Size;
+    for (const ImWchar* range = ranges; range[0] && range[1]; range += 2)
+        for (unsigned int c = range[0]; c <= range[1] && c <= IM_UNICODE_CODEPOINT_MAX; c++)
+        {
+            if (c < (unsigned int)baked->IndexLookup.Size && baked->IndexLookup.Data[c] != IM_FONTGLYPH_INDEX_UNUSED)
+                continue;
+            ImWchar codepoint = (ImWchar)c;
+            ImFontAtlas_FontHookRemapCodepoint(atlas, font, &codepoint);
+            if (codepoint == font->EllipsisChar && font->EllipsisAutoBake)
+                continue;
+
+            // Pick the source ImFontBaked_BuildLoadGlyph() would use. Glyphs from other loaders are left to it.
+            ImFontConfig* job_src = NULL;
+            int job_src_n = 0;
+            for (ImFontConfig* src : font->Sources)
+            {
+                const ImFontLoader* loader = src->FontLoader ? src->FontLoader : atlas->FontLoader;
+                if ((!src->GlyphExcludeRanges || ImFontAtlasBuildAcceptCodepointForSource(src, codepoint)) && loader->FontSrcContainsGlyph(atlas, src, codepoint))
+                {
+                    if (loader->FontSrcInit == ImGui_ImplStbTrueType_FontSrcInit)
+                        job_src = src;
+                    break;
+                }
+                job_src_n++;
+            }
+            if (job_src == NULL)
+                continue;
+
+            ImFontGlyphJob job;
+            ImFontAtlasGlyphJobInit(&job, job_src, job_src_n, baked, (ImWchar)c, codepoint);
+            jobs->push_back(job);
+            ImFontBaked_BuildGrowIndex(baked, c + 1);
+            baked->IndexAdvanceX[c] = baked->FallbackAdvanceX;
+            baked->IndexLookup[c] = IM_FONTGLYPH_INDEX_NOT_FOUND;
+        }
+    return jobs->Size - jobs_count;
+}
+
+void ImFontAtlasGlyphJobRun(ImFontGlyphJob* job)
+{
+    IM_ASSERT(job->Pixels == NULL);
+    job->Loaded = ImGui_ImplStbTrueType_RasterizeGlyph(job);
+}
+
+// Return the baked of a job if its glyph is still waiting for it (the baked may have been discarded, or the glyph loaded otherwise)
+static ImFontBaked* ImFontAtlasGlyphJobGetBaked(ImFontAtlas* atlas, ImFontGlyphJob* job)
+{
+    ImFontBaked* baked = atlas->Builder ? (ImFontBaked*)atlas->Builder->BakedMap.GetVoidPtr(job->BakedId) : NULL;
+    if (baked == NULL || job->Codepoint >= baked->IndexLookup.Size || baked->IndexLookup[job->Codepoint] != IM_FONTGLYPH_INDEX_NOT_FOUND)
+        return NULL;
+    return baked;
+}
+
+int ImFontAtlasGlyphJobsCommit(ImFontAtlas* atlas, ImVector<ImFontGlyphJob>* jobs)
+{
+    int glyphs_added = 0;
+    for (ImFontGlyphJob& job : *jobs)
+    {
+        ImFontBaked* baked = ImFontAtlasGlyphJobGetBaked(atlas, &job);
+        ImFontGlyph glyph;
+        if (baked != NULL && job.Loaded && ImFontAtlasGlyphJobPack(atlas, baked, &job, &glyph))
+        {
+            glyph.Codepoint = job.Codepoint;
+            glyph.SourceIdx = job.SrcIdx;
+            ImFontAtlasBakedAddFontGlyph(atlas, baked, job.Src, &glyph);
+            glyphs_added++;
+        }
+        ImFontAtlasGlyphJobFreePixels(&job);
+    }
+    jobs->resize(0);
+    return glyphs_added;
+}
+
+void ImFontAtlasGlyphJobsClear(ImFontAtlas* atlas, ImVector<ImFontGlyphJob>* jobs)
+{
+    for (ImFontGlyphJob& job : *jobs)
+    {
+        if (ImFontBaked* baked = ImFontAtlasGlyphJobGetBaked(atlas, &job))
+        {
+            baked->IndexAdvanceX[job.Codepoint] = -1.0f;
+            baked->IndexLookup[job.Codepoint] = IM_FONTGLYPH_INDEX_UNUSED;
+        }
+        ImFontAtlasGlyphJobFreePixels(&job);
+    }
+    jobs->resize(0);
+}
+
 #endif // IMGUI_ENABLE_STB_TRUETYPE
 
 //-------------------------------------------------------------------------
@@ -5319,6 +5624,12 @@ ImFontBaked* ImFont::GetFontBaked(float size, float density)
 
     if (density < 0.0f)
         density = CurrentRasterizerDensity;
+    if (OwnerAtlas->Flags & ImFontAtlasFlags_SignedDistanceField)
+    {
+        // Distance fields scale: every size is drawn from the single bake at the font's size
+        size = LegacySize;
+        density = 1.0f;
+    }
     if (baked && baked->Size == size && baked->RasterizerDensity == density)
         return baked;
 
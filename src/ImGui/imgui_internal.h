@@ -72,6 +72,12 @@ Index of this file:
 #if defined(IMGUI_ENABLE_SSE4_2) && !defined(IMGUI_USE_LEGACY_CRC32_ADLER) && !defined(__EMSCRIPTEN__)
 #define IMGUI_ENABLE_SSE4_2_CRC
 #endif
+// ARMv8 CRC32 instructions, when compiled with them (e.g. -march=armv8-a+crc). Unlike SSE 4.2 they cover both the CRC32c
+// and the legacy CRC32 tables, so IDs are identical to the table-driven code either way.
+#if defined(__ARM_FEATURE_CRC32) && !defined(IMGUI_DISABLE_ARM_CRC)
+#define IMGUI_ENABLE_ARM_CRC
+#include <arm_acle.h>
+#endif
 
 // Visual Studio warnings
 #ifdef _MSC_VER
@@ -3765,6 +3771,38 @@ struct ImFontLoader
 
 #ifdef IMGUI_ENABLE_STB_TRUETYPE
 IMGUI_API const ImFontLoader* ImFontAtlasGetFontLoaderForStbTruetype();
+
+// Glyph pre-rasterization, for sources using the stb_truetype loader.
+// Rasterizing is most of the cost of loading a glyph and only reads font data, so it can be spread over worker threads owned by the application:
+// - ImFontAtlasGlyphJobsQueue(): owning thread. Add a job for every glyph of 'ranges' not loaded yet in 'baked'. Queued glyphs draw as the fallback glyph meanwhile.
+// - ImFontAtlasGlyphJobRun(): any thread, jobs are independent. Allocates through the allocator functions directly (thread-safe if they are).
+// - ImFontAtlasGlyphJobsCommit(): owning thread, outside of NewFrame()/Render(). Pack glyphs and write pixels in queue order, then clear the list.
+// Fonts and sources must stay alive while jobs are queued: commit or ImFontAtlasGlyphJobsClear() before removing them.
+struct ImFontGlyphJob
+{
+    ImFontConfig*   Src;
+    int             SrcIdx;
+    ImGuiID         BakedId;                // Baked is looked up again on commit, as it may have been discarded meanwhile
+    ImWchar         Codepoint;
+    ImWchar         LoaderCodepoint;        // After ImFont::RemapPairs
+    bool            Sdf;
+    float           Size;
+    float           RasterizerDensity;
+    int             OversampleH, OversampleV;
+    float           Ascent;
+    float           RefSize;                // Size of the font's first source, GlyphOffset is relative to it
+
+    // [Output]
+    bool            Loaded;
+    ImFontGlyph     Glyph;                  // PackId/UV are filled on commit
+    int             Width, Height;
+    unsigned char*  Pixels;                 // Alpha8, Width * Height. NULL when there is nothing to draw.
+};
+
+IMGUI_API int               ImFontAtlasGlyphJobsQueue(ImFontAtlas* atlas, ImFontBaked* baked, const ImWchar* ranges, ImVector<ImFontGlyphJob>* jobs); // Return number of jobs added
+IMGUI_API void              ImFontAtlasGlyphJobRun(ImFontGlyphJob* job);
+IMGUI_API int               ImFontAtlasGlyphJobsCommit(ImFontAtlas* atlas, ImVector<ImFontGlyphJob>* jobs); // Return number of glyphs added
+IMGUI_API void              ImFontAtlasGlyphJobsClear(ImFontAtlas* atlas, ImVector<ImFontGlyphJob>* jobs);  // Drop jobs without committing, queued glyphs will load on next use
 #endif
 #ifndef IMGUI_DISABLE_OBSOLETE_FUNCTIONS
 typedef ImFontLoader ImFontBuilderIO; // [renamed/changed in 1.92] The types are not actually compatible but we provide this as a compile-time error report helper.
@@ -3776,6 +3814,7 @@ typedef ImFontLoader ImFontBuilderIO; // [renamed/changed in 1.92] The types are
 
 #define IMGUI_FONT_SIZE_MAX                                     (512.0f)
 #define IMGUI_FONT_SIZE_THRESHOLD_FOR_LOADADVANCEXONLYMODE      (128.0f)
+#define IMGUI_FONT_SDF_PADDING                                  (4)         // Texels of distance stored around glyph outlines with ImFontAtlasFlags_SignedDistanceField
 
 // Helpers: ImTextureRef ==/!= operators provided as convenience
 // (note that _TexID and _TexData are never set simultaneously)
@@ -3819,21 +3858,26 @@ struct ImFontAtlasPostProcessData
     int                 Height;
 };
 
-// We avoid dragging imstb_rectpack.h into public header (partly because binding generators are having issues with it)
-#ifdef IMGUI_STB_NAMESPACE
-namespace IMGUI_STB_NAMESPACE { struct stbrp_node; }
-typedef IMGUI_STB_NAMESPACE::stbrp_node stbrp_node_im;
-#else
-struct stbrp_node;
-typedef stbrp_node stbrp_node_im;
-#endif
-struct stbrp_context_opaque { char data[80]; };
+// Skyline packer used by ImFontAtlasPackAddRect(), tuned for adding rectangles one at a time.
+// - New rectangles go at the lowest spot of the skyline (bottom-left), leftmost on ties. Finding it walks the skyline,
+//   which is linear in its node count (up to about a hundred for a glyph atlas); there is no logarithmic segment index.
+// - Discarded rectangles leave holes which are reused first, so the texture only needs repacking once they run out.
+//   Holes are bucketed by height class (log2) and sorted by width within a bucket, so finding a hole or the position for
+//   a new one is a binary search; the vector insert/erase that follows still shifts the tail of the bucket.
+// - tools/pack_benchmark replays glyph sizes from the default font through the packer.
+#define IM_FONTATLAS_PACK_HOLE_CLASSES  10                  // Heights 1..511+, larger holes share the last bucket
+#define IM_FONTATLAS_PACK_HOLE_MIN_SIZE 3                   // Smaller leftovers are dropped until next repack
+struct ImFontAtlasSkylineNode
+{
+    unsigned short              X, Y;                   // Segment from X to next node's X (or to the packing width), filled up to Y
+};
 
 // Internal storage for incrementally packing and building a ImFontAtlas
 struct ImFontAtlasBuilder
 {
-    stbrp_context_opaque        PackContext;            // Actually 'stbrp_context' but we don't want to define this in the header file.
-    ImVector<stbrp_node_im>     PackNodes;
+    ImVec2i                     PackSize;
+    ImVector<ImFontAtlasSkylineNode> PackSkyline;       // Sorted by X, adjacent nodes never have the same Y
+    ImVector<ImTextureRect>     PackHoles[IM_FONTATLAS_PACK_HOLE_CLASSES]; // Includes padding
     ImVector<ImTextureRect>     Rects;
     ImVector<ImFontAtlasRectEntry> RectsIndex;          // ImFontAtlasRectId -> index into Rects[]
     ImVector<unsigned char>     TempBuffer;             // Misc scratch buffer
@@ -0,0 +1,230 @@
+#include <cfloat>
+#include <cstdint>
+#include <cstdlib>
+
+#include "Menu.h"
+
+bool motion_blur_enabled = false;
+float blur_strength = 0.85f;
+bool blur_zero_copy = false;
+int blur_scale_index = 0;
+int blur_path = BlurPath_HardwareBlend;
+int blur_history_format = HistoryFormat_Auto;
+bool blur_skip_static = true;
+float blur_static_threshold = 0.004f;
+bool postPassEnabled[PostPass_COUNT] = {false, false, false};
+float post_sharpen = 0.35f;
+float post_grade[3] = {1.05f, 1.15f, 0.0f};
+float post_vignette = 0.4f;
+bool overlay_shared_context = false;
+bool overlay_idle_skip = true;
+bool overlay_sdf_font = false;
+bool gl_shadow_verify = false;
+int overlay_rate_index = 0;
+
+PatchSettings g_PatchSettings = {false, false, false, false, 5};
+RenderStats g_MenuStats = {-1, 0, 0, false, false, false, 1.0f, -1.0f, 0};
+ImGui_ImplOpenGL3_FrameStats g_OverlayDrawStats = {};
+
+static constexpr int kMenuVtxReserve = 2048;
+static const char* blurScaleNames[] = {"Full", "1/2", "1/3", "1/4"};
+static const char* blurPathNames[] = {"Three-Pass", "Hardware Blend"};
+static const char* historyFormatNames[] = {"Auto", "RGBA8", "RGB565", "RGB10_A2", "R11F_G11F_B10F"};
+static const char* overlayRateNames[] = {"Game", "60 Hz", "30 Hz", "20 Hz"};
+
+// ImGui allocator, installed before the context is created. Blocks up to 4 KB come from size-class slabs: 64 KB pages carved
+// into blocks that go back on a per-class free list instead of to malloc, so the vectors and scratch buffers ImGui grows and
+// frees every frame settle into reused blocks after the first frames. Larger blocks (vertex/index buffers) use malloc.
+// Glyph worker threads allocate as well, hence the per-class spinlock. Every block has a 16-byte header with its class and size.
+static constexpr size_t kAllocHeader = 16, kAllocSlabPage = 64 * 1024;
+static constexpr uint32_t kAllocClassSizes[] = { 16, 32, 48, 64, 80, 96, 112, 128, 256, 512, 1024, 2048, 4096 };
+static constexpr int kAllocClassCount = sizeof(kAllocClassSizes) / sizeof(kAllocClassSizes[0]), kAllocLarge = kAllocClassCount;
+struct AllocHeader { uint32_t sizeClass, size; };
+struct AllocClass { std::atomic_flag lock = ATOMIC_FLAG_INIT; void* freeList = nullptr; };
+static AllocClass g_AllocClasses[kAllocClassCount];
+
+std::atomic<uint32_t> g_AllocCalls{0};
+std::atomic<size_t> g_AllocLive{0};
+AllocFrameStats g_AllocLastFrame = {};
+static std::atomic<uint32_t> g_AllocMallocs{0};
+static std::atomic<size_t> g_AllocBytes{0}, g_AllocPeak{0};
+
+static int allocClassFor(size_t size) {
+    if (size <= 128) return size == 0 ? 0 : (int)((size - 1) / 16);
+    for (int c = 8; c < kAllocClassCount; c++) if (size <= kAllocClassSizes[c]) return c;
+    return kAllocLarge;
+}
+
+void* overlayAlloc(size_t size, void*) {
+    int sizeClass = allocClassFor(size);
+    g_AllocCalls.fetch_add(1, std::memory_order_relaxed);
+    g_AllocBytes.fetch_add(size, std::memory_order_relaxed);
+    size_t live = g_AllocLive.fetch_add(size, std::memory_order_relaxed) + size;
+    for (size_t peak = g_AllocPeak.load(std::memory_order_relaxed); live > peak && !g_AllocPeak.compare_exchange_weak(peak, live, std::memory_order_relaxed);) {}
+
+    uint8_t* block = nullptr;
+    if (sizeClass == kAllocLarge) {
+        g_AllocMallocs.fetch_add(1, std::memory_order_relaxed);
+        block = (uint8_t*)malloc(kAllocHeader + size);
+    } else {
+        AllocClass& cls = g_AllocClasses[sizeClass];
+        while (cls.lock.test_and_set(std::memory_order_acquire)) {}
+        if (!cls.freeList) {
+            // Refill from a new page, never returned: the slabs only grow to the high-water mark of each class
+            size_t stride = kAllocHeader + kAllocClassSizes[sizeClass], count = kAllocSlabPage / stride;
+            uint8_t* page = (uint8_t*)malloc(stride * count);
+            g_AllocMallocs.fetch_add(1, std::memory_order_relaxed);
+            for (size_t i = 0; page && i < count; i++) { *(void**)(page + i * stride) = cls.freeList; cls.freeList = page + i * stride; }
+        }
+        block = (uint8_t*)cls.freeList;
+        if (block) cls.freeList = *(void**)block;
+        cls.lock.clear(std::memory_order_release);
+    }
+    if (!block) return nullptr;
+    *(AllocHeader*)block = { (uint32_t)sizeClass, (uint32_t)size };
+    return block + kAllocHeader;
+}
+
+void overlayFree(void* ptr, void*) {
+    if (!ptr) return;
+    uint8_t* block = (uint8_t*)ptr - kAllocHeader;
+    AllocHeader header = *(AllocHeader*)block;
+    g_AllocLive.fetch_sub(header.size, std::memory_order_relaxed);
+    if (header.sizeClass == (uint32_t)kAllocLarge) { free(block); return; }
+    AllocClass& cls = g_AllocClasses[header.sizeClass];
+    while (cls.lock.test_and_set(std::memory_order_acquire)) {}
+    *(void**)block = cls.freeList; cls.freeList = block;
+    cls.lock.clear(std::memory_order_release);
+}
+
+void allocFrameEnd() {
+    size_t live = g_AllocLive.load(std::memory_order_relaxed);
+    g_AllocLastFrame = { g_AllocCalls.exchange(0, std::memory_order_relaxed), g_AllocMallocs.exchange(0, std::memory_order_relaxed),
+                         g_AllocBytes.exchange(0, std::memory_order_relaxed),
+                         g_AllocPeak.exchange(live, std::memory_order_relaxed), live };
+}
+
+ImGuiContext* createMenuContext() {
+    ImGui::SetAllocatorFunctions(overlayAlloc, overlayFree, nullptr);
+    ImGuiContext* ctx = ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.ConfigFlags |= ImGuiConfigFlags_IsTouchScreen;
+    io.ConfigMemoryCompactTimer = FLT_MAX; // Never free buffers of hidden windows/popups, reopening them would allocate again
+    return ctx;
+}
+
+void DrawMenu() {
+    ImGui::SetNextWindowPos(ImVec2(10, 80), ImGuiCond_FirstUseEver);
+    ImGui::Begin("AnarchyArray Menu", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
+    // Room for the menu with every section open (about 1200 vertices), so expanding one doesn't regrow the buffers step by step
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    if (drawList->VtxBuffer.Capacity < kMenuVtxReserve) { drawList->VtxBuffer.reserve(kMenuVtxReserve); drawList->IdxBuffer.reserve(kMenuVtxReserve * 2); drawList->_Path.reserve(64); }
+
+    if (ImGui::CollapsingHeader("Minecraft Patches", ImGuiTreeNodeFlags_DefaultOpen)) {
+        PatchSettings& p = g_PatchSettings;
+        ImGui::Checkbox("InfinitySpread", &p.infinitySpread);
+        ImGui::Checkbox("SpongeRange+", &p.spongePlus);
+        ImGui::BeginDisabled(!p.spongePlus);
+        ImGui::Checkbox("SpongeRange++", &p.spongePlusPlus);
+        ImGui::EndDisabled();
+
+        ImGui::Checkbox("Sponge All", &p.spongeAll);
+
+        ImGui::BeginDisabled(p.spongeAll);
+        ImGui::Text("Absorb Type:"); ImGui::SameLine();
+        ImGui::SetNextItemWidth(50);
+        ImGui::InputInt("##absorbDisplay", &p.absorbType, 0, 0, ImGuiInputTextFlags_ReadOnly); ImGui::SameLine();
+        
+        ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(6, 6)); ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 4));
+        if (ImGui::Button("K", ImVec2(ImGui::GetFrameHeight(), ImGui::GetFrameHeight()))) ImGui::OpenPopup("AbsorbKeypad");
+        ImGui::SameLine();
+        if (ImGui::Button("i", ImVec2(ImGui::GetFrameHeight(), ImGui::GetFrameHeight()))) ImGui::OpenPopup("AbsorbTypeInfo");
+        ImGui::SameLine();
+        if (ImGui::Button("-", ImVec2(ImGui::GetFrameHeight(), ImGui::GetFrameHeight())) && p.absorbType > 0) p.absorbType--;
+        ImGui::SameLine();
+        if (ImGui::Button("+", ImVec2(ImGui::GetFrameHeight(), ImGui::GetFrameHeight())) && p.absorbType < 575) p.absorbType++;
+        ImGui::PopStyleVar(2);
+        ImGui::EndDisabled();
+
+        if (ImGui::BeginPopup("AbsorbTypeInfo", ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::Text("0=Air, 1=Dirt, 2=Wood, 5=Water, 6=Lava, 12=TNT...");
+            if (ImGui::Button("Close")) ImGui::CloseCurrentPopup();
+            ImGui::EndPopup();
+        }
+
+        if (ImGui::BeginPopup("AbsorbKeypad", ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize)) {
+            ImGui::Text("Keypad");
+            const float cw = 60.0f, rh = 50.0f;
+            static const char* const digitLabels[] = { "0", "1", "2", "3", "4", "5", "6", "7", "8", "9" };
+            for (int i=1; i<=9; i++) {
+                if (ImGui::Button(digitLabels[i], ImVec2(cw, rh))) p.absorbType = p.absorbType * 10 + i;
+                if (i % 3 != 0) ImGui::SameLine();
+            }
+            ImGui::Dummy(ImVec2(cw, rh)); ImGui::SameLine();
+            if (ImGui::Button("0", ImVec2(cw, rh))) p.absorbType = p.absorbType * 10;
+            ImGui::SameLine();
+            if (ImGui::Button("<-", ImVec2(cw, rh))) p.absorbType /= 10;
+            if (ImGui::Button("Close", ImVec2(cw*3+8, rh/2))) ImGui::CloseCurrentPopup();
+            ImGui::EndPopup();
+        }
+    }
+
+    if (ImGui::CollapsingHeader("Visual Effects", ImGuiTreeNodeFlags_DefaultOpen)) {
+        ImGui::Checkbox("Enable Motion Blur", &motion_blur_enabled);
+        if (motion_blur_enabled) {
+            ImGui::Text("Blur Strength");
+            ImGui::SliderFloat("##Strength", &blur_strength, 0.0f, 0.98f, "%.2f");
+            ImGui::Text("Resolution"); ImGui::SameLine();
+            ImGui::SetNextItemWidth(120);
+            ImGui::Combo("##Resolution", &blur_scale_index, blurScaleNames, IM_ARRAYSIZE(blurScaleNames));
+            ImGui::Text("Path"); ImGui::SameLine();
+            ImGui::SetNextItemWidth(200);
+            ImGui::Combo("##Path", &blur_path, blurPathNames, IM_ARRAYSIZE(blurPathNames));
+            ImGui::Text("History"); ImGui::SameLine();
+            ImGui::SetNextItemWidth(200);
+            ImGui::Combo("##HistoryFormat", &blur_history_format, historyFormatNames, IM_ARRAYSIZE(historyFormatNames));
+            if (g_MenuStats.historyFormat >= 0) { ImGui::SameLine(); ImGui::TextDisabled("(%s)", historyFormatNames[g_MenuStats.historyFormat]); }
+            ImGui::Checkbox("Skip When Static", &blur_skip_static);
+            if (blur_skip_static) { ImGui::SameLine(); ImGui::TextDisabled(g_MenuStats.sceneStatic ? "(static)" : "(moving %.3f)", g_MenuStats.frameDifference); }
+            if (g_MenuStats.gpuMs >= 0.0f) ImGui::Text("GPU: %.2f ms", g_MenuStats.gpuMs);
+        }
+        ImGui::Checkbox("Sharpen", &postPassEnabled[PostPass_Sharpen]);
+        if (postPassEnabled[PostPass_Sharpen]) ImGui::SliderFloat("##Sharpen", &post_sharpen, 0.0f, 1.0f, "%.2f");
+        ImGui::Checkbox("Color Grade", &postPassEnabled[PostPass_ColorGrade]);
+        if (postPassEnabled[PostPass_ColorGrade]) {
+            ImGui::SliderFloat("Contrast", &post_grade[0], 0.5f, 1.5f, "%.2f");
+            ImGui::SliderFloat("Saturation", &post_grade[1], 0.0f, 2.0f, "%.2f");
+            ImGui::SliderFloat("Brightness", &post_grade[2], -0.25f, 0.25f, "%.2f");
+        }
+        ImGui::Checkbox("Vignette", &postPassEnabled[PostPass_Vignette]);
+        if (postPassEnabled[PostPass_Vignette]) ImGui::SliderFloat("##Vignette", &post_vignette, 0.0f, 1.0f, "%.2f");
+        ImGui::BeginDisabled(!g_MenuStats.zeroCopyAvailable);
+        ImGui::Checkbox("Zero-Copy Capture", &blur_zero_copy);
+        ImGui::EndDisabled();
+        ImGui::Text("Passes: %d  Targets: %.1f MB", g_MenuStats.passes, (float)g_MenuStats.targetBytes / (1024.0f * 1024.0f));
+    }
+
+    if (ImGui::CollapsingHeader("Overlay")) {
+        ImGui::Checkbox("Separate Overlay Context", &overlay_shared_context);
+        ImGui::Checkbox("Skip Idle Frames", &overlay_idle_skip);
+        ImGui::Checkbox("Distance Field Font", &overlay_sdf_font);
+        ImGui::Text("Update Rate"); ImGui::SameLine();
+        ImGui::SetNextItemWidth(120);
+        ImGui::Combo("##OverlayRate", &overlay_rate_index, overlayRateNames, IM_ARRAYSIZE(overlayRateNames));
+        ImGui::Text("Draw Calls: %d  (%d commands)  GL Calls: %d", g_OverlayDrawStats.DrawCalls, g_OverlayDrawStats.DrawCmds, g_OverlayDrawStats.GlCalls);
+        ImGui::Text("Allocs: %u  (%.1f KB, %u from malloc)  Peak: %.1f KB  Live: %.1f KB", g_AllocLastFrame.calls, g_AllocLastFrame.bytes / 1024.0f,
+                    g_AllocLastFrame.mallocs, g_AllocLastFrame.peak / 1024.0f, g_AllocLastFrame.live / 1024.0f);
+    }
+
+    if (ImGui::CollapsingHeader("Debug")) {
+        ImGui::BeginDisabled(!g_MenuStats.shadowAvailable);
+        ImGui::Checkbox("Verify GL State Shadow", &gl_shadow_verify);
+        ImGui::EndDisabled();
+        if (!g_MenuStats.shadowAvailable) { ImGui::SameLine(); ImGui::TextDisabled("(unavailable)"); }
+        else if (gl_shadow_verify) { ImGui::SameLine(); ImGui::TextDisabled("(%d mismatches)", g_MenuStats.shadowMismatches); }
+    }
+
+    ImGui::End();
+}
+
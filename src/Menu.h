@@ -0,0 +1,60 @@
+#pragma once
+// The overlay menu and the ImGui allocator it runs on. Kept apart from main.cpp so they build without the hooks and GL,
+// which lets tools/ run the menu on the host. The menu only edits the settings below; main.cpp reads them each frame and
+// applies patches and render passes itself.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "ImGui/imgui.h"
+#include "ImGui/backends/imgui_impl_opengl3.h"
+
+enum PostPassId { PostPass_Sharpen, PostPass_ColorGrade, PostPass_Vignette, PostPass_COUNT };
+enum BlurPath { BlurPath_ThreePass, BlurPath_HardwareBlend };
+enum HistoryFormat { HistoryFormat_Auto, HistoryFormat_RGBA8, HistoryFormat_RGB565, HistoryFormat_RGB10A2, HistoryFormat_R11G11B10F, HistoryFormat_COUNT };
+
+extern bool motion_blur_enabled;
+extern float blur_strength;
+extern bool blur_zero_copy;
+extern int blur_scale_index;
+extern int blur_path;
+extern int blur_history_format;
+extern bool blur_skip_static;
+extern float blur_static_threshold;
+extern bool postPassEnabled[PostPass_COUNT];
+extern float post_sharpen;
+extern float post_grade[3]; // contrast, saturation, brightness
+extern float post_vignette;
+extern bool overlay_shared_context;
+extern bool overlay_idle_skip;
+extern bool overlay_sdf_font;
+extern bool gl_shadow_verify;
+extern int overlay_rate_index;
+
+// Minecraft patch toggles; main.cpp writes the code once the signatures are found and whenever these change.
+struct PatchSettings { bool infinitySpread, spongePlus, spongePlusPlus, spongeAll; int absorbType; };
+extern PatchSettings g_PatchSettings;
+
+// What the menu shows about the render thread's passes, copied from the render thread (see captureRenderStats in main.cpp).
+struct RenderStats {
+    int historyFormat, passes, shadowMismatches; // historyFormat -1: no history
+    bool sceneStatic, zeroCopyAvailable, shadowAvailable;
+    float frameDifference, gpuMs; // gpuMs < 0: no timer
+    size_t targetBytes;
+};
+extern RenderStats g_MenuStats;
+extern ImGui_ImplOpenGL3_FrameStats g_OverlayDrawStats; // last overlay draw, filled before DrawMenu
+
+// Counters for the frame being built; allocFrameEnd() moves them to g_AllocLastFrame for display.
+struct AllocFrameStats { uint32_t calls, mallocs; size_t bytes, peak, live; };
+extern std::atomic<uint32_t> g_AllocCalls;
+extern std::atomic<size_t> g_AllocLive;
+extern AllocFrameStats g_AllocLastFrame;
+void* overlayAlloc(size_t size, void*);
+void overlayFree(void* ptr, void*);
+void allocFrameEnd();
+
+// Creates the overlay's ImGui context on overlayAlloc with the menu's io settings.
+ImGuiContext* createMenuContext();
+void DrawMenu();
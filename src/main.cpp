@@ -1,7 +1,12 @@
+#include <cerrno>
 #include <cstdint>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <ctime>
 #include <vector>
 #include <array>
+#include <atomic>
 #include <string>
 
 #include <jni.h>
@@ -12,16 +17,22 @@
 #include <EGL/egl.h>
 #include <GLES2/gl2.h>
 #include <GLES3/gl3.h>
+#include <GLES2/gl2ext.h>
 
 #include <pthread.h>
 #include <signal.h>
 #include <unistd.h>
 #include <dlfcn.h>
+#include <sys/stat.h>
 
 #include "pl/Hook.h"
 #include "pl/Gloss.h"
 
+#include "BakedFont.h"
+#include "Menu.h"
+
 #include "ImGui/imgui.h"
+#include "ImGui/imgui_internal.h"
 #include "ImGui/backends/imgui_impl_opengl3.h"
 #include "ImGui/backends/imgui_impl_android.h"
 
@@ -30,6 +41,10 @@
 static bool g_Initialized = false;
 static int g_Width = 0, g_Height = 0;
 static ANativeWindow* g_Window = nullptr;
+static EGLSurface g_WindowSurface = EGL_NO_SURFACE;
+// Size of g_WindowSurface, read when it is created and again only after a resize is seen (see updateSurfaceSize).
+static int g_SurfaceWidth = 0, g_SurfaceHeight = 0;
+static std::atomic<bool> g_SurfaceSizeStale{true};
 
 static ANativeWindow* (*orig_ANativeWindow_fromSurface)(JNIEnv* env, jobject surface) = nullptr;
 static EGLBoolean (*orig_eglMakeCurrent)(EGLDisplay, EGLSurface, EGLSurface, EGLContext) = nullptr;
@@ -40,194 +55,1195 @@ static bool g_PatchesReady = false;
 static std::vector<uintptr_t> g_PatchAddrs;
 static std::vector<std::array<uint8_t,4>> g_Originals;
 
-const char* vertexShaderSource = R"(
-attribute vec4 aPosition;
-attribute vec2 aTexCoord;
-varying vec2 vTexCoord;
+// Attributeless fullscreen triangle: vertices 0..2 cover clip space, so no vertex or index buffers are bound.
+const char* fullscreenVertexShaderSource = R"(#version 300 es
+out vec2 vTexCoord;
 void main() {
-    gl_Position = aPosition;
-    vTexCoord = aTexCoord;
+    vec2 uv = vec2(float((gl_VertexID << 1) & 2), float(gl_VertexID & 2));
+    vTexCoord = uv;
+    gl_Position = vec4(uv * 2.0 - 1.0, 0.0, 1.0);
 }
 )";
 
-const char* blendFragmentShaderSource = R"(
+const char* blendFragmentShaderSource = R"(#version 300 es
 precision mediump float;
-varying vec2 vTexCoord;
+in vec2 vTexCoord;
 uniform sampler2D uCurrentFrame;
 uniform sampler2D uHistoryFrame;
+uniform vec4 uCurrentRect;
+uniform vec4 uHistoryRect;
 uniform float uBlendFactor;
+uniform float uDitherStep;
+uniform highp float uNoiseOffset;
+out vec4 fragColor;
+// Dithering by one LSB of the target format keeps the recursive blend from getting stuck a few steps short of the new frame.
+highp float noise(highp vec2 p) {
+    return fract(52.9829189 * fract(dot(p, vec2(0.06711056, 0.00583715))));
+}
+void main() {
+    vec4 current = texture(uCurrentFrame, min(vTexCoord * uCurrentRect.xy, uCurrentRect.zw));
+    vec4 history = texture(uHistoryFrame, min(vTexCoord * uHistoryRect.xy, uHistoryRect.zw));
+    vec3 result = mix(current.rgb, history.rgb, uBlendFactor);
+    result += (noise(gl_FragCoord.xy + uNoiseOffset) - 0.5) * uDitherStep;
+    fragColor = vec4(result, 1.0);
+}
+)";
+
+const char* drawFragmentShaderSource = R"(#version 300 es
+precision mediump float;
+in vec2 vTexCoord;
+uniform sampler2D uTexture;
+uniform vec4 uTextureRect;
+out vec4 fragColor;
 void main() {
-    vec4 current = texture2D(uCurrentFrame, vTexCoord);
-    vec4 history = texture2D(uHistoryFrame, vTexCoord);
-    vec4 result = mix(current, history, uBlendFactor);
-    gl_FragColor = vec4(result.rgb, 1.0);
+    fragColor = vec4(texture(uTexture, min(vTexCoord * uTextureRect.xy, uTextureRect.zw)).rgb, 1.0);
 }
 )";
 
-const char* drawFragmentShaderSource = R"(
+// The overlay texture holds premultiplied color: ImGui blends (SRC_ALPHA, ONE_MINUS_SRC_ALPHA) for color and
+// (ONE, ONE_MINUS_SRC_ALPHA) for alpha into a target cleared to zero.
+const char* overlayFragmentShaderSource = R"(#version 300 es
 precision mediump float;
-varying vec2 vTexCoord;
+in vec2 vTexCoord;
 uniform sampler2D uTexture;
+uniform vec4 uTextureRect;
+out vec4 fragColor;
+void main() {
+    fragColor = texture(uTexture, min(vTexCoord * uTextureRect.xy, uTextureRect.zw));
+}
+)";
+
+const char* fetchBlendFragmentShaderSource = R"(#version 300 es
+#extension GL_EXT_shader_framebuffer_fetch : require
+precision mediump float;
+in vec2 vTexCoord;
+uniform sampler2D uHistoryFrame;
+uniform vec4 uHistoryRect;
+uniform float uBlendFactor;
+inout vec4 fragColor;
 void main() {
-    vec4 color = texture2D(uTexture, vTexCoord);
-    gl_FragColor = vec4(color.rgb, 1.0);
+    vec4 history = texture(uHistoryFrame, min(vTexCoord * uHistoryRect.xy, uHistoryRect.zw));
+    fragColor = vec4(mix(fragColor.rgb, history.rgb, uBlendFactor), 1.0);
 }
 )";
 
-static bool motion_blur_enabled = false;
-static float blur_strength = 0.85f;
+// Effect passes are fused into one program per group: the prologue reads the group's input, then every pass in the group
+// rewrites 'color' in declaration order. Only the first pass of a group may sample neighbours through readInput().
+const char* postFragmentPrologue = R"(#version 300 es
+precision mediump float;
+in vec2 vTexCoord;
+uniform sampler2D uInput;
+uniform vec4 uInputRect;
+uniform vec2 uTexel;
+out vec4 fragColor;
+vec3 readInput(vec2 uv) { return texture(uInput, min(uv * uInputRect.xy, uInputRect.zw)).rgb; }
+)";
+
+struct PostPass {
+    const char* name;
+    int stage;          // passes run in stage order
+    bool neighborhood;  // reads around the pixel, so its input must already be in a texture
+    const char* declarations;
+    const char* body;
+};
+
+static const PostPass postPasses[PostPass_COUNT] = {
+    {"Sharpen", 0, true, "uniform float uSharpen;\n",
+     "    color += (4.0 * color - readInput(uv + vec2(uTexel.x, 0.0)) - readInput(uv - vec2(uTexel.x, 0.0))\n"
+     "        - readInput(uv + vec2(0.0, uTexel.y)) - readInput(uv - vec2(0.0, uTexel.y))) * uSharpen;\n"},
+    {"Color Grade", 1, false, "uniform vec3 uGrade;\n",
+     "    color = (color - 0.5) * uGrade.x + 0.5 + uGrade.z;\n"
+     "    color = mix(vec3(dot(color, vec3(0.2126, 0.7152, 0.0722))), color, uGrade.y);\n"},
+    {"Vignette", 2, false, "uniform float uVignette;\n",
+     "    color *= 1.0 - uVignette * smoothstep(0.2, 0.8, length(uv - 0.5));\n"},
+};
+
+// Per-option tables the render code needs, parallel to the menu's choices
+static const int blurScaleDivisors[] = {1, 2, 3, 4};
+static const GLenum historyFormatEnums[] = {GL_RGBA8, GL_RGBA8, GL_RGB565, GL_RGB10_A2, GL_R11F_G11F_B10F};
+static const float historyFormatDither[] = {1.0f / 255.0f, 1.0f / 255.0f, 1.0f / 31.0f, 1.0f / 1023.0f, 0.0f};
+static const int overlayRates[] = {0, 60, 30, 20};
+static std::atomic<uint32_t> g_InputSerial{0};
+
+// Menu settings the game's render thread acts on. DrawMenu edits the settings in Menu.h on whichever thread builds the overlay,
+// the render thread only reads this copy: taken from the globals at the start of Render() while the menu is built there,
+// and from the copy the overlay worker publishes with each frame (under g_OverlayMutex) while it runs on its own thread.
+struct RenderSettings {
+    bool motionBlur, zeroCopy, skipStatic, sharedContext, shadowVerify, postPasses[PostPass_COUNT];
+    int scaleIndex, path, historyFormat;
+    float blurStrength, staticThreshold, sharpen, grade[3], vignette;
+};
+static RenderSettings g_RenderSettings = {};
+
+static RenderSettings captureRenderSettings() {
+    RenderSettings r;
+    r.motionBlur = motion_blur_enabled; r.zeroCopy = blur_zero_copy; r.skipStatic = blur_skip_static;
+    r.sharedContext = overlay_shared_context; r.shadowVerify = gl_shadow_verify;
+    for (int i = 0; i < PostPass_COUNT; i++) r.postPasses[i] = postPassEnabled[i];
+    r.scaleIndex = blur_scale_index; r.path = blur_path; r.historyFormat = blur_history_format;
+    r.blurStrength = blur_strength; r.staticThreshold = blur_static_threshold;
+    r.sharpen = post_sharpen; r.grade[0] = post_grade[0]; r.grade[1] = post_grade[1]; r.grade[2] = post_grade[2]; r.vignette = post_vignette;
+    return r;
+}
+
+// Pooled offscreen target. Storage only grows to the largest size requested; a smaller request renders into the
+// lower-left width x height sub-rectangle, and samplers are told the used extent through a uv scale/clamp rect.
+struct RenderTarget {
+    GLuint texture = 0, fbo = 0, depthStencil = 0;
+    GLenum format = 0;
+    int allocWidth = 0, allocHeight = 0, width = 0, height = 0;
+    double lastUsed = 0.0;
+};
+
+static RenderTarget rawTarget, historyTargets[2], sceneTarget, postTargets[2], overlayTarget;
+static RenderTarget* const pooledTargets[] = {&rawTarget, &historyTargets[0], &historyTargets[1], &sceneTarget, &postTargets[0], &postTargets[1], &overlayTarget};
+static constexpr double kTargetIdleSeconds = 10.0;
+static thread_local double t_FrameTime = 0.0; // pool clock: the render thread's frame, or the one the overlay worker draws for
 
-static GLuint rawTexture = 0;
-static GLuint historyTextures[2] = {0, 0};
-static GLuint historyFBOs[2] = {0, 0};
 static int pingPongIndex = 0;
 static bool isFirstFrame = true;
+static GLenum surfaceFormat = GL_RGBA8;
+static int historyFormat = HistoryFormat_RGBA8, accum_format_setting = -1;
+static int formatRenderable[HistoryFormat_COUNT] = {-1, -1, -1, -1, -1};
+static unsigned int blurFrameCounter = 0;
+static bool rawCaptured = false;
+
+// The probe is read from the last level of a small mip chain, so every readback texel averages an 8x8 block of the
+// first level instead of the 2x2 bilinear footprint a single full-res blit would sample. Readbacks go through a ring of
+// pixel-pack buffers deep enough for GPUs that run a few frames behind.
+static constexpr int kProbeWidth = 64, kProbeHeight = 36, kProbeLevels = 4, kProbeSlots = 4, kProbeMaxLag = 4;
+static GLuint probeTexture = 0, probeFBOs[2] = {0, 0}, probePBOs[kProbeSlots] = {}; // [0] level 0, [1] last level
+static GLsync probeFences[kProbeSlots] = {};
+static int probeHead = 0, probePending = 0, probeLag = 0, staticFrames = 0;
+static uint8_t probeLuma[kProbeWidth * kProbeHeight];
+static bool probeLumaValid = false;
+static float frameDifference = 1.0f;
+static bool defaultFBMultisampled = false;
 
 static GLuint blendShaderProgram = 0;
-static GLint blendPosLoc = -1, blendTexCoordLoc = -1, blendCurrentLoc = -1, blendHistoryLoc = -1, blendFactorLoc = -1;
+static GLint blendFactorLoc = -1, blendDitherLoc = -1, blendNoiseLoc = -1, blendCurrentRectLoc = -1, blendHistoryRectLoc = -1;
 static GLuint drawShaderProgram = 0;
-static GLint drawPosLoc = -1, drawTexCoordLoc = -1, drawTextureLoc = -1;
-static GLuint vertexBuffer = 0, indexBuffer = 0;
+static GLint drawRectLoc = -1;
+static GLuint fetchBlendProgram = 0;
+static GLint fetchFactorLoc = -1, fetchRectLoc = -1;
+static GLuint fullscreenVAO = 0;
+static GLuint overlayCompositeProgram = 0;
+static GLint overlayRectLoc = -1;
+static int fullscreenPassCount = 0, lastFullscreenPasses = 0;
+
+struct PostGroup { GLuint program; GLint inputRectLoc, texelLoc, sharpenLoc, gradeLoc, vignetteLoc; };
+static PostGroup postGroupPrograms[1 << PostPass_COUNT] = {}; // indexed by the mask of fused passes
+static int postPassOrder[PostPass_COUNT];
+static std::vector<uint32_t> postGroupMasks;
+static uint32_t postGraphMask = ~0u;
+static int accum_path = -1;
 static int blur_res_width = 0, blur_res_height = 0;
+static int accum_res_width = 0, accum_res_height = 0;
+
+static void (*orig_glBindFramebuffer)(GLenum, GLuint) = nullptr;
+static GLuint g_RedirectFBO = 0;
+static bool g_InRender = false;
+static thread_local bool t_IsRenderThread = false;
+
+static bool HasGLExtension(const char* name) {
+    const char* exts = (const char*)glGetString(GL_EXTENSIONS);
+    if (!exts) return false;
+    size_t len = strlen(name);
+    for (const char* p = strstr(exts, name); p; p = strstr(p + len, name)) {
+        if ((p == exts || p[-1] == ' ') && (p[len] == ' ' || p[len] == '\0')) return true;
+    }
+    return false;
+}
 
-void initializeMotionBlurResources(GLint width, GLint height) {
-    if (rawTexture != 0) {
-        glDeleteTextures(1, &rawTexture); glDeleteTextures(2, historyTextures); glDeleteFramebuffers(2, historyFBOs);
+// GPU time of the blur passes via EXT_disjoint_timer_query, read back a few frames late so it never stalls.
+struct GpuTimer {
+    static constexpr int kQueries = 4;
+    GLuint queries[kQueries] = {};
+    bool pending[kQueries] = {};
+    int index = 0;
+    bool supported = false, initialized = false, active = false;
+    float lastMs = 0.0f, avgMs = 0.0f;
+    PFNGLGETQUERYOBJECTUI64VEXTPROC getQueryObjectui64v = nullptr;
+
+    void Init() {
+        initialized = true;
+        getQueryObjectui64v = (PFNGLGETQUERYOBJECTUI64VEXTPROC)eglGetProcAddress("glGetQueryObjectui64vEXT");
+        supported = getQueryObjectui64v && HasGLExtension("GL_EXT_disjoint_timer_query");
+        if (supported) glGenQueries(kQueries, queries);
+    }
+    void Begin() {
+        if (!initialized) Init();
+        if (!supported) return;
+        Collect();
+        if (pending[index]) return;
+        glBeginQuery(GL_TIME_ELAPSED_EXT, queries[index]);
+        active = true;
     }
-    if (blendShaderProgram == 0) {
-        GLuint vs = glCreateShader(GL_VERTEX_SHADER);
-        glShaderSource(vs, 1, &vertexShaderSource, nullptr); glCompileShader(vs);
+    void End() {
+        if (!active) return;
+        glEndQuery(GL_TIME_ELAPSED_EXT);
+        pending[index] = true; index = (index + 1) % kQueries; active = false;
+    }
+    void Collect() {
+        GLint disjoint = 0;
+        glGetIntegerv(GL_GPU_DISJOINT_EXT, &disjoint);
+        for (int i = 0; i < kQueries; i++) {
+            if (!pending[i]) continue;
+            GLuint available = 0;
+            glGetQueryObjectuiv(queries[i], GL_QUERY_RESULT_AVAILABLE, &available);
+            if (!available) continue;
+            GLuint64 ns = 0;
+            getQueryObjectui64v(queries[i], GL_QUERY_RESULT, &ns);
+            pending[i] = false;
+            if (disjoint) continue;
+            lastMs = (float)((double)ns / 1.0e6);
+            avgMs = avgMs == 0.0f ? lastMs : avgMs * 0.95f + lastMs * 0.05f;
+        }
+    }
+};
 
-        GLuint fsBlend = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fsBlend, 1, &blendFragmentShaderSource, nullptr); glCompileShader(fsBlend);
+static GpuTimer g_BlurTimer;
 
-        blendShaderProgram = glCreateProgram();
-        glAttachShader(blendShaderProgram, vs); glAttachShader(blendShaderProgram, fsBlend); glLinkProgram(blendShaderProgram);
+static void createTargetTexture(GLuint tex, GLenum internalFormat, GLint width, GLint height) {
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, internalFormat, width, height);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+}
 
-        blendPosLoc = glGetAttribLocation(blendShaderProgram, "aPosition");
-        blendTexCoordLoc = glGetAttribLocation(blendShaderProgram, "aTexCoord");
-        blendCurrentLoc = glGetUniformLocation(blendShaderProgram, "uCurrentFrame");
-        blendHistoryLoc = glGetUniformLocation(blendShaderProgram, "uHistoryFrame");
-        blendFactorLoc = glGetUniformLocation(blendShaderProgram, "uBlendFactor");
+static double monotonicSeconds() {
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec * 1.0e-9;
+}
 
-        GLuint fsDraw = glCreateShader(GL_FRAGMENT_SHADER);
-        glShaderSource(fsDraw, 1, &drawFragmentShaderSource, nullptr); glCompileShader(fsDraw);
+static void releaseRenderTarget(RenderTarget& rt) {
+    if (rt.fbo == 0) return;
+    glDeleteTextures(1, &rt.texture); glDeleteFramebuffers(1, &rt.fbo);
+    if (rt.depthStencil != 0) glDeleteRenderbuffers(1, &rt.depthStencil);
+    rt = RenderTarget();
+}
 
-        drawShaderProgram = glCreateProgram();
-        glAttachShader(drawShaderProgram, vs); glAttachShader(drawShaderProgram, fsDraw); glLinkProgram(drawShaderProgram);
+// Returns true when the storage was (re)created and its contents are undefined. Requests that fit the current
+// allocation with the same format only move the active sub-rectangle, so a rotation or split-screen resize costs nothing.
+static bool acquireRenderTarget(RenderTarget& rt, GLenum format, int width, int height, bool depthStencil) {
+    rt.lastUsed = t_FrameTime;
+    bool fits = rt.fbo != 0 && rt.format == format && width <= rt.allocWidth && height <= rt.allocHeight && (rt.depthStencil != 0) == depthStencil;
+    if (fits) { rt.width = width; rt.height = height; return false; }
+
+    int allocWidth = rt.format == format ? std::max(width, rt.allocWidth) : width;
+    int allocHeight = rt.format == format ? std::max(height, rt.allocHeight) : height;
+    releaseRenderTarget(rt);
+    glGenTextures(1, &rt.texture); glGenFramebuffers(1, &rt.fbo);
+    createTargetTexture(rt.texture, format, allocWidth, allocHeight);
+    glBindFramebuffer(GL_FRAMEBUFFER, rt.fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, rt.texture, 0);
+    if (depthStencil) {
+        glGenRenderbuffers(1, &rt.depthStencil);
+        glBindRenderbuffer(GL_RENDERBUFFER, rt.depthStencil);
+        glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, allocWidth, allocHeight);
+        glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER, rt.depthStencil);
+        glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    }
+    glBindFramebuffer(GL_FRAMEBUFFER, 0); glBindTexture(GL_TEXTURE_2D, 0);
+    rt.format = format; rt.allocWidth = allocWidth; rt.allocHeight = allocHeight; rt.width = width; rt.height = height;
+    rt.lastUsed = t_FrameTime;
+    return true;
+}
+
+static void releaseIdleRenderTargets() {
+    for (RenderTarget* rt : pooledTargets) {
+        if (rt->fbo != 0 && t_FrameTime - rt->lastUsed > kTargetIdleSeconds) releaseRenderTarget(*rt);
+    }
+}
+
+static size_t renderTargetPoolBytes() {
+    size_t total = 0;
+    for (const RenderTarget* rt : pooledTargets) {
+        if (rt->fbo == 0) continue;
+        size_t pixels = (size_t)rt->allocWidth * rt->allocHeight;
+        total += pixels * (rt->format == GL_RGB565 ? 2 : 4) + (rt->depthStencil != 0 ? pixels * 4 : 0);
+    }
+    return total;
+}
+
+// Maps the fullscreen [0,1] uv onto the used sub-rectangle, clamped half a texel inside so filtering never reads the unused area.
+static void setTargetRect(GLint location, const RenderTarget& rt) {
+    float sx = (float)rt.width / (float)rt.allocWidth, sy = (float)rt.height / (float)rt.allocHeight;
+    glUniform4f(location, sx, sy, sx - 0.5f / (float)rt.allocWidth, sy - 0.5f / (float)rt.allocHeight);
+}
 
-        drawPosLoc = glGetAttribLocation(drawShaderProgram, "aPosition");
-        drawTexCoordLoc = glGetAttribLocation(drawShaderProgram, "aTexCoord");
-        drawTextureLoc = glGetUniformLocation(drawShaderProgram, "uTexture");
+// The capture copy and the MSAA resolve both require the raw texture to match the window surface's color format.
+static void queryDefaultFramebufferFormat() {
+    GLint sampleBuffers = 0, redBits = 8, alphaBits = 8;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glGetIntegerv(GL_SAMPLE_BUFFERS, &sampleBuffers);
+    glGetIntegerv(GL_RED_BITS, &redBits);
+    glGetIntegerv(GL_ALPHA_BITS, &alphaBits);
+    defaultFBMultisampled = sampleBuffers > 0;
+    if (redBits == 5) surfaceFormat = GL_RGB565;
+    else if (alphaBits == 0) surfaceFormat = GL_RGB8;
+    else surfaceFormat = GL_RGBA8;
+}
 
-        GLfloat vertices[] = { -1.0f, 1.0f, 0.0f, 1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 1.0f, -1.0f, 1.0f, 0.0f, 1.0f, 1.0f, 1.0f, 1.0f };
-        GLushort indices[] = { 0, 1, 2, 0, 2, 3 };
+static bool isColorRenderable(int format) {
+    if (formatRenderable[format] >= 0) return formatRenderable[format] != 0;
+    GLuint tex = 0, fbo = 0;
+    glGenTextures(1, &tex); glGenFramebuffers(1, &fbo);
+    glBindTexture(GL_TEXTURE_2D, tex);
+    glTexStorage2D(GL_TEXTURE_2D, 1, historyFormatEnums[format], 4, 4);
+    glBindFramebuffer(GL_FRAMEBUFFER, fbo);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, tex, 0);
+    bool complete = glCheckFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    glDeleteFramebuffers(1, &fbo); glDeleteTextures(1, &tex);
+    formatRenderable[format] = complete ? 1 : 0;
+    return complete;
+}
 
-        glGenBuffers(1, &vertexBuffer); glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer); glBufferData(GL_ARRAY_BUFFER, sizeof(vertices), vertices, GL_STATIC_DRAW);
-        glGenBuffers(1, &indexBuffer); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer); glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
+// Auto takes the first format the driver reports renderable from the path's preference list. The three-pass history is
+// written by the dithered blend shader, so RGB565 halves it without banding. The hardware-blend path fills its history with
+// a blit, which can neither dither nor convert to float: 565 would get stuck short of the new frame there, so it takes
+// RGB10_A2 (the size of RGBA8 with two more bits per channel) and never uses R11F_G11F_B10F.
+static const int threePassAutoFormats[] = {HistoryFormat_RGB565, HistoryFormat_RGB10A2, HistoryFormat_RGBA8};
+static const int blitAutoFormats[] = {HistoryFormat_RGB10A2, HistoryFormat_RGBA8};
+
+static int resolveHistoryFormat() {
+    bool blitTarget = g_RenderSettings.path == BlurPath_HardwareBlend;
+    int format = g_RenderSettings.historyFormat;
+    if (format == HistoryFormat_Auto) {
+        const int* candidates = blitTarget ? blitAutoFormats : threePassAutoFormats;
+        int count = blitTarget ? IM_ARRAYSIZE(blitAutoFormats) : IM_ARRAYSIZE(threePassAutoFormats);
+        format = HistoryFormat_RGBA8;
+        for (int i = 0; i < count; i++) if (isColorRenderable(candidates[i])) { format = candidates[i]; break; }
+    }
+    if (format == HistoryFormat_R11G11B10F) {
+        GLint major = 0, minor = 0;
+        glGetIntegerv(GL_MAJOR_VERSION, &major); glGetIntegerv(GL_MINOR_VERSION, &minor);
+        bool floatRenderable = HasGLExtension("GL_EXT_color_buffer_float") || major * 10 + minor >= 32;
+        if (blitTarget || !floatRenderable) format = HistoryFormat_RGB10A2;
     }
+    if (!isColorRenderable(format)) format = HistoryFormat_RGBA8;
+    return format;
+}
 
-    glGenTextures(1, &rawTexture); glBindTexture(GL_TEXTURE_2D, rawTexture);
-    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+// Program binaries live in the mod's data directory, one file per program, named by a hash of the renderer string,
+// the driver version string and the shader sources; a driver update therefore simply misses instead of loading stale code.
+struct ProgramCacheHeader { uint32_t magic, format, length; };
+static constexpr uint32_t kProgramCacheMagic = 0x31504141; // "AAP1"
+static std::string g_ProgramCacheDir;
+static std::vector<GLint> g_ProgramBinaryFormats;
+static bool g_ProgramCacheChecked = false;
+
+static uint64_t hashString(uint64_t hash, const char* str) {
+    for (; str && *str; str++) { hash ^= (uint8_t)*str; hash *= 1099511628211ull; }
+    return hash * 1099511628211ull;
+}
+
+// The mod's data directory is a program_cache directory next to its own library, where the loader keeps mods in the
+// launcher's data. When that is not writable (a library extracted under /data/app) the game's cache directory is used,
+// built from the running uid so secondary users and work profiles land in their own /data/user/<N>.
+static std::string programCacheDirectory() {
+    Dl_info info = {};
+    if (dladdr((void*)&programCacheDirectory, &info) && info.dli_fname && strrchr(info.dli_fname, '/')) {
+        std::string dir(info.dli_fname, strrchr(info.dli_fname, '/') + 1 - info.dli_fname);
+        dir += "program_cache/";
+        if ((mkdir(dir.c_str(), 0700) == 0 || errno == EEXIST) && access(dir.c_str(), W_OK) == 0) return dir;
+    }
+    char package[256] = {};
+    if (FILE* f = fopen("/proc/self/cmdline", "rb")) { fread(package, 1, sizeof(package) - 1, f); fclose(f); }
+    if (char* colon = strchr(package, ':')) *colon = '\0';
+    if (package[0] == '\0') return std::string();
+    char dir[320];
+    snprintf(dir, sizeof(dir), "/data/user/%u/%s/cache/", (unsigned)(getuid() / 100000), package);
+    return dir;
+}
+
+static bool programCachePath(const char* glslVersion, const char* vertexSource, const char* fragmentSource, char* path, size_t size) {
+    if (!g_ProgramCacheChecked) {
+        g_ProgramCacheChecked = true;
+        GLint count = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &count);
+        g_ProgramBinaryFormats.resize(count > 0 ? count : 0);
+        if (count > 0) glGetIntegerv(GL_PROGRAM_BINARY_FORMATS, g_ProgramBinaryFormats.data());
+        if (count > 0) g_ProgramCacheDir = programCacheDirectory();
+    }
+    if (g_ProgramCacheDir.empty()) return false;
+    uint64_t hash = 14695981039346656037ull;
+    for (const char* str : {(const char*)glGetString(GL_RENDERER), (const char*)glGetString(GL_VERSION), glslVersion, vertexSource, fragmentSource}) hash = hashString(hash, str);
+    snprintf(path, size, "%saa_program_%016llx.bin", g_ProgramCacheDir.c_str(), (unsigned long long)hash);
+    return true;
+}
+
+// Returns true if a cached binary linked into program. On a miss the binary hint is left set for the source link that follows.
+static bool loadCachedProgram(GLuint program, const char* glslVersion, const char* vertexSource, const char* fragmentSource) {
+    char path[512];
+    if (!programCachePath(glslVersion, vertexSource, fragmentSource, path, sizeof(path))) return false;
+    glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    ProgramCacheHeader header = {};
+    std::vector<uint8_t> binary;
+    bool ok = fread(&header, sizeof(header), 1, f) == 1 && header.magic == kProgramCacheMagic && header.length > 0 && header.length < (8u << 20);
+    if (ok) { binary.resize(header.length); ok = fread(binary.data(), 1, header.length, f) == header.length; }
+    fclose(f);
+    bool knownFormat = false;
+    for (GLint format : g_ProgramBinaryFormats) knownFormat |= (GLenum)format == header.format;
+    if (ok && knownFormat) {
+        glProgramBinary(program, header.format, binary.data(), (GLsizei)header.length);
+        GLint linked = GL_FALSE;
+        glGetProgramiv(program, GL_LINK_STATUS, &linked);
+        if (linked) return true;
+    }
+    unlink(path);
+    return false;
+}
+
+// Written to a temporary file and renamed, so a crash mid-write never leaves a truncated binary behind.
+static void storeCachedProgram(GLuint program, const char* glslVersion, const char* vertexSource, const char* fragmentSource) {
+    char path[512];
+    if (!programCachePath(glslVersion, vertexSource, fragmentSource, path, sizeof(path))) return;
+    GLint length = 0;
+    glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) return;
+    std::vector<uint8_t> binary(length);
+    GLenum format = 0;
+    glGetProgramBinary(program, length, &length, &format, binary.data());
+    if (length <= 0) return;
+
+    std::string tmpPath = std::string(path) + ".tmp";
+    FILE* f = fopen(tmpPath.c_str(), "wb");
+    if (!f) return;
+    ProgramCacheHeader header = {kProgramCacheMagic, format, (uint32_t)length};
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(binary.data(), 1, length, f) == (size_t)length;
+    ok = fclose(f) == 0 && ok;
+    if (ok) rename(tmpPath.c_str(), path);
+    else unlink(tmpPath.c_str());
+}
+
+static GLuint linkProgram(const char* vertexSource, const char* fragmentSource) {
+    GLuint program = glCreateProgram();
+    if (loadCachedProgram(program, "", vertexSource, fragmentSource)) return program;
+
+    GLuint vs = glCreateShader(GL_VERTEX_SHADER);
+    glShaderSource(vs, 1, &vertexSource, nullptr); glCompileShader(vs);
+    GLuint fs = glCreateShader(GL_FRAGMENT_SHADER);
+    glShaderSource(fs, 1, &fragmentSource, nullptr); glCompileShader(fs);
+
+    glAttachShader(program, vs); glAttachShader(program, fs); glLinkProgram(program);
+    glDeleteShader(vs); glDeleteShader(fs);
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program, GL_LINK_STATUS, &linked);
+    if (!linked) { glDeleteProgram(program); return 0; }
+    storeCachedProgram(program, "", vertexSource, fragmentSource);
+    return program;
+}
+
+// Sampler units never change, so they are set once here instead of on every pass.
+static void initializeBlurPrograms() {
+    if (blendShaderProgram != 0) return;
+    blendShaderProgram = linkProgram(fullscreenVertexShaderSource, blendFragmentShaderSource);
+    glUseProgram(blendShaderProgram);
+    glUniform1i(glGetUniformLocation(blendShaderProgram, "uCurrentFrame"), 0);
+    glUniform1i(glGetUniformLocation(blendShaderProgram, "uHistoryFrame"), 1);
+    blendFactorLoc = glGetUniformLocation(blendShaderProgram, "uBlendFactor");
+    blendDitherLoc = glGetUniformLocation(blendShaderProgram, "uDitherStep");
+    blendNoiseLoc = glGetUniformLocation(blendShaderProgram, "uNoiseOffset");
+    blendCurrentRectLoc = glGetUniformLocation(blendShaderProgram, "uCurrentRect");
+    blendHistoryRectLoc = glGetUniformLocation(blendShaderProgram, "uHistoryRect");
+
+    drawShaderProgram = linkProgram(fullscreenVertexShaderSource, drawFragmentShaderSource);
+    glUseProgram(drawShaderProgram);
+    glUniform1i(glGetUniformLocation(drawShaderProgram, "uTexture"), 0);
+    drawRectLoc = glGetUniformLocation(drawShaderProgram, "uTextureRect");
+
+    overlayCompositeProgram = linkProgram(fullscreenVertexShaderSource, overlayFragmentShaderSource);
+    glUseProgram(overlayCompositeProgram);
+    glUniform1i(glGetUniformLocation(overlayCompositeProgram, "uTexture"), 0);
+    overlayRectLoc = glGetUniformLocation(overlayCompositeProgram, "uTextureRect");
+
+    if (HasGLExtension("GL_EXT_shader_framebuffer_fetch")) {
+        fetchBlendProgram = linkProgram(fullscreenVertexShaderSource, fetchBlendFragmentShaderSource);
+        if (fetchBlendProgram != 0) {
+            glUseProgram(fetchBlendProgram);
+            glUniform1i(glGetUniformLocation(fetchBlendProgram, "uHistoryFrame"), 0);
+            fetchFactorLoc = glGetUniformLocation(fetchBlendProgram, "uBlendFactor");
+            fetchRectLoc = glGetUniformLocation(fetchBlendProgram, "uHistoryRect");
+        }
+    }
+
+    glGenVertexArrays(1, &fullscreenVAO);
+}
+
+// Lets tile-based GPUs skip loading (or storing) attachments whose contents are about to be overwritten or are no longer needed.
+static void invalidateDrawFramebuffer(bool isDefault, bool color, bool depthStencil) {
+    GLenum attachments[3]; GLsizei count = 0;
+    if (color) attachments[count++] = isDefault ? GL_COLOR : GL_COLOR_ATTACHMENT0;
+    if (depthStencil && isDefault) { attachments[count++] = GL_DEPTH; attachments[count++] = GL_STENCIL; }
+    else if (depthStencil) attachments[count++] = GL_DEPTH_STENCIL_ATTACHMENT;
+    if (count > 0) glInvalidateFramebuffer(GL_DRAW_FRAMEBUFFER, count, attachments);
+}
+
+// Only a change of size, path or format reseeds the history; the targets themselves come from the pool and are
+// reallocated only when they have to grow or change format.
+static void prepareMotionBlurTargets(GLint width, GLint height, GLint accumWidth, GLint accumHeight) {
+    if (width != blur_res_width || height != blur_res_height || accumWidth != accum_res_width || accumHeight != accum_res_height ||
+        g_RenderSettings.path != accum_path || g_RenderSettings.historyFormat != accum_format_setting) {
+        initializeBlurPrograms();
+        queryDefaultFramebufferFormat();
+        historyFormat = resolveHistoryFormat();
+        blur_res_width = width; blur_res_height = height; accum_res_width = accumWidth; accum_res_height = accumHeight;
+        accum_path = g_RenderSettings.path; accum_format_setting = g_RenderSettings.historyFormat; pingPongIndex = 0; isFirstFrame = true;
+    }
+    // The hardware-blend path keeps a single accumulation target in historyTargets[0]; the second one idles out of the pool.
+    int count = g_RenderSettings.path == BlurPath_HardwareBlend ? 1 : 2;
+    for (int i = 0; i < count; i++) {
+        if (acquireRenderTarget(historyTargets[i], historyFormatEnums[historyFormat], accumWidth, accumHeight, false)) isFirstFrame = true;
+    }
+}
+
+// A multisampled surface can only be resolved at its own size, so the raw copy then stays full-size and the blend pass downsamples it.
+static void acquireRawTarget(GLint width, GLint height) {
+    bool fixedPointHistory = historyFormat != HistoryFormat_R11G11B10F;
+    GLenum format = defaultFBMultisampled || !fixedPointHistory ? surfaceFormat : historyFormatEnums[historyFormat];
+    acquireRenderTarget(rawTarget, format, defaultFBMultisampled ? width : accum_res_width, defaultFBMultisampled ? height : accum_res_height, false);
+}
+
+static void drawFullscreenTriangle() {
+    fullscreenPassCount++;
+    glBindVertexArray(fullscreenVAO);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+}
+
+static void drawFullscreenTexture(const RenderTarget& source) {
+    glUseProgram(drawShaderProgram); glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, source.texture);
+    setTargetRect(drawRectLoc, source);
+    drawFullscreenTriangle();
+}
+
+static void drawBlendedTextures(const RenderTarget& current, const RenderTarget& history, float factor, float ditherStep) {
+    glUseProgram(blendShaderProgram);
+    glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, current.texture);
+    glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, history.texture);
+    setTargetRect(blendCurrentRectLoc, current); setTargetRect(blendHistoryRectLoc, history);
+    glUniform1f(blendFactorLoc, factor);
+    glUniform1f(blendDitherLoc, ditherStep);
+    glUniform1f(blendNoiseLoc, (float)(blurFrameCounter % 64) * 5.588238f);
+    drawFullscreenTriangle();
+    glActiveTexture(GL_TEXTURE0);
+}
+
+static void captureDefaultFramebuffer(int width, int height) {
+    if (rawCaptured) return;
+    rawCaptured = true;
+    acquireRawTarget(width, height);
+    fullscreenPassCount++;
+    if (defaultFBMultisampled || rawTarget.width != width || rawTarget.height != height || rawTarget.format != surfaceFormat) {
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0); glBindFramebuffer(GL_DRAW_FRAMEBUFFER, rawTarget.fbo);
+        invalidateDrawFramebuffer(false, true, false);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, rawTarget.width, rawTarget.height, GL_COLOR_BUFFER_BIT, rawTarget.width == width ? GL_NEAREST : GL_LINEAR);
+        glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    } else {
+        glBindTexture(GL_TEXTURE_2D, rawTarget.texture);
+        glCopyTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 0, 0, width, height);
+    }
+}
+
+// Writes the frame (source, or the backbuffer when null) into dst's used area; a multisampled backbuffer is resolved
+// through the raw target first.
+static void blitFrameToTarget(const RenderTarget* source, const RenderTarget& dst, int width, int height) {
+    GLuint readFBO = source ? source->fbo : 0;
+    int readWidth = width, readHeight = height;
+    fullscreenPassCount++;
+    if (!source && defaultFBMultisampled) {
+        captureDefaultFramebuffer(width, height);
+        readFBO = rawTarget.fbo; readWidth = rawTarget.width; readHeight = rawTarget.height;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO); glBindFramebuffer(GL_DRAW_FRAMEBUFFER, dst.fbo);
+    invalidateDrawFramebuffer(false, true, false);
+    bool scaled = readWidth != dst.width || readHeight != dst.height;
+    glBlitFramebuffer(0, 0, readWidth, readHeight, 0, 0, dst.width, dst.height, GL_COLOR_BUFFER_BIT, scaled ? GL_LINEAR : GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
 
-    glGenTextures(2, historyTextures); glGenFramebuffers(2, historyFBOs);
+static void initializeMotionProbe() {
+    glGenTextures(1, &probeTexture); glGenFramebuffers(2, probeFBOs); glGenBuffers(kProbeSlots, probePBOs);
+    glBindTexture(GL_TEXTURE_2D, probeTexture);
+    glTexStorage2D(GL_TEXTURE_2D, kProbeLevels, GL_RGBA8, kProbeWidth << (kProbeLevels - 1), kProbeHeight << (kProbeLevels - 1));
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
     for (int i = 0; i < 2; i++) {
-        glBindTexture(GL_TEXTURE_2D, historyTextures[i]);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE); glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-        glBindFramebuffer(GL_FRAMEBUFFER, historyFBOs[i]);
-        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, historyTextures[i], 0);
-        glClearColor(0, 0, 0, 1); glClear(GL_COLOR_BUFFER_BIT);
+        glBindFramebuffer(GL_FRAMEBUFFER, probeFBOs[i]);
+        glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D, probeTexture, i == 0 ? 0 : kProbeLevels - 1);
     }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0); glBindTexture(GL_TEXTURE_2D, 0);
-    blur_res_width = width; blur_res_height = height; pingPongIndex = 0; isFirstFrame = true;
+    for (int i = 0; i < kProbeSlots; i++) {
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, probePBOs[i]);
+        glBufferData(GL_PIXEL_PACK_BUFFER, kProbeWidth * kProbeHeight * 4, nullptr, GL_STREAM_READ);
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+}
+
+// Reads back, oldest first, every probe the GPU is already done with and compares each one's luminance to the one before.
+static void collectMotionProbes() {
+    while (probePending > 0) {
+        int slot = (probeHead - probePending + kProbeSlots) % kProbeSlots;
+        GLenum status = glClientWaitSync(probeFences[slot], 0, 0);
+        if (status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED) break;
+        glDeleteSync(probeFences[slot]); probeFences[slot] = nullptr;
+        probePending--;
+
+        glBindBuffer(GL_PIXEL_PACK_BUFFER, probePBOs[slot]);
+        const uint8_t* pixels = (const uint8_t*)glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, kProbeWidth * kProbeHeight * 4, GL_MAP_READ_BIT);
+        if (!pixels) continue;
+        uint32_t total = 0;
+        for (int i = 0; i < kProbeWidth * kProbeHeight; i++) {
+            const uint8_t* p = pixels + i * 4;
+            uint8_t luma = (uint8_t)((p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8);
+            total += (uint32_t)abs((int)luma - (int)probeLuma[i]);
+            probeLuma[i] = luma;
+        }
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+        frameDifference = probeLumaValid ? (float)total / (255.0f * kProbeWidth * kProbeHeight) : 1.0f;
+        probeLumaValid = true;
+        staticFrames = frameDifference < g_RenderSettings.staticThreshold ? staticFrames + 1 : 0;
+        probeLag = 0;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+}
+
+// Downsamples the current frame through the probe's mip chain and queues an async readback, so the verdict lags by as many
+// frames as the GPU is behind. Without a fresh reading for kProbeMaxLag frames the scene counts as moving again; a full ring
+// skips this frame's probe rather than dropping one still in flight.
+static bool updateMotionProbe(int width, int height, const RenderTarget* source) {
+    if (probeFBOs[0] == 0) initializeMotionProbe();
+    probeLag++;
+    collectMotionProbes();
+    if (probeLag > kProbeMaxLag) staticFrames = 0;
+    if (probePending == kProbeSlots) return staticFrames >= 2;
+
+    GLuint readFBO = source ? source->fbo : 0;
+    int readWidth = width, readHeight = height;
+    if (!source && defaultFBMultisampled) {
+        captureDefaultFramebuffer(width, height);
+        readFBO = rawTarget.fbo; readWidth = rawTarget.width; readHeight = rawTarget.height;
+    }
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, readFBO); glBindFramebuffer(GL_DRAW_FRAMEBUFFER, probeFBOs[0]);
+    invalidateDrawFramebuffer(false, true, false);
+    glBlitFramebuffer(0, 0, readWidth, readHeight, 0, 0, kProbeWidth << (kProbeLevels - 1), kProbeHeight << (kProbeLevels - 1), GL_COLOR_BUFFER_BIT, GL_LINEAR);
+    glBindTexture(GL_TEXTURE_2D, probeTexture);
+    glGenerateMipmap(GL_TEXTURE_2D);
+
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, probeFBOs[1]);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, probePBOs[probeHead]);
+    glReadPixels(0, 0, kProbeWidth, kProbeHeight, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    probeFences[probeHead] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    probeHead = (probeHead + 1) % kProbeSlots;
+    probePending++;
+
+    return staticFrames >= 2;
 }
 
-void apply_motion_blur(int width, int height) {
-    if (width != blur_res_width || height != blur_res_height || rawTexture == 0) initializeMotionBlurResources(width, height);
+// Blend color is not part of GLState, so passes that change blending put all of it back themselves.
+struct BlendState { GLint srcRGB, dstRGB, srcAlpha, dstAlpha, eqRGB, eqAlpha; GLfloat color[4]; };
 
+static void saveBlendState(BlendState& b) {
+    glGetIntegerv(GL_BLEND_SRC_RGB, &b.srcRGB); glGetIntegerv(GL_BLEND_DST_RGB, &b.dstRGB);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &b.srcAlpha); glGetIntegerv(GL_BLEND_DST_ALPHA, &b.dstAlpha);
+    glGetIntegerv(GL_BLEND_EQUATION_RGB, &b.eqRGB); glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &b.eqAlpha);
+    glGetFloatv(GL_BLEND_COLOR, b.color);
+}
+
+static void restoreBlendState(const BlendState& b) {
+    glBlendFuncSeparate(b.srcRGB, b.dstRGB, b.srcAlpha, b.dstAlpha); glBlendEquationSeparate(b.eqRGB, b.eqAlpha);
+    glBlendColor(b.color[0], b.color[1], b.color[2], b.color[3]);
+}
+
+// Blends the upsampled history over the frame already in the backbuffer: in-shader via framebuffer fetch when available,
+// otherwise with GL_CONSTANT_ALPHA blending and the game's blend state put back afterwards.
+static void compositeHistoryOverBackbuffer(const RenderTarget& history, float factor) {
+    if (fetchBlendProgram != 0) {
+        glUseProgram(fetchBlendProgram); glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, history.texture);
+        glUniform1f(fetchFactorLoc, factor); setTargetRect(fetchRectLoc, history);
+        drawFullscreenTriangle();
+        return;
+    }
+    BlendState blend;
+    saveBlendState(blend);
+    glEnable(GL_BLEND); glBlendEquation(GL_FUNC_ADD);
+    glBlendColor(0.0f, 0.0f, 0.0f, factor);
+    glBlendFunc(GL_CONSTANT_ALPHA, GL_ONE_MINUS_CONSTANT_ALPHA);
+    drawFullscreenTexture(history);
+    restoreBlendState(blend);
+    glDisable(GL_BLEND);
+}
+
+// History accumulates at 1/N resolution; the composite blends the upsampled previous history over the full-res frame,
+// which equals the full-res recursive blend without losing the current frame's detail. The result goes to output when the
+// frame is in a texture and later passes need it there, otherwise to the backbuffer; the return value says which (null = backbuffer).
+const RenderTarget* apply_motion_blur(int width, int height, const RenderTarget* source, const RenderTarget* output) {
+    int divisor = blurScaleDivisors[g_RenderSettings.scaleIndex];
+    int accumWidth = (width + divisor - 1) / divisor, accumHeight = (height + divisor - 1) / divisor;
+    prepareMotionBlurTargets(width, height, accumWidth, accumHeight);
+
+    g_BlurTimer.Begin();
+    blurFrameCounter++;
+    rawCaptured = false;
     glDisable(GL_SCISSOR_TEST); glDisable(GL_DEPTH_TEST); glDisable(GL_BLEND);
-    glBindTexture(GL_TEXTURE_2D, rawTexture);
-    glCopyTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 0, 0, width, height, 0);
+    bool frameInBackbuffer = source == nullptr;
+    GLuint outputFBO = output ? output->fbo : 0;
+    // The game's depth/stencil is dead at this point; when the frame lives in a scene texture the backbuffer is fully overwritten too.
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+    invalidateDrawFramebuffer(true, !frameInBackbuffer, true);
+
+    // Static scene: the blur would reproduce the input, so skip it and restart the history from the next moving frame.
+    if (g_RenderSettings.skipStatic && updateMotionProbe(width, height, source)) {
+        isFirstFrame = true;
+        g_BlurTimer.End();
+        if (output || frameInBackbuffer) return source;
+        glViewport(0, 0, width, height);
+        drawFullscreenTexture(*source);
+        return nullptr;
+    }
 
-    int curr = pingPongIndex, prev = 1 - pingPongIndex;
-    if (isFirstFrame) {
-        glBindFramebuffer(GL_FRAMEBUFFER, historyFBOs[curr]); glViewport(0, 0, width, height);
-        glUseProgram(drawShaderProgram); glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, rawTexture); glUniform1i(drawTextureLoc, 0);
-        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-        glEnableVertexAttribArray(drawPosLoc); glVertexAttribPointer(drawPosLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
-        glEnableVertexAttribArray(drawTexCoordLoc); glVertexAttribPointer(drawTexCoordLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+    // Hardware-blend path: composite the accumulation texture over the frame, then the composited frame becomes the new history.
+    if (g_RenderSettings.path == BlurPath_HardwareBlend) {
+        glBindFramebuffer(GL_FRAMEBUFFER, outputFBO); glViewport(0, 0, width, height);
+        if (output) invalidateDrawFramebuffer(false, true, false);
+        if (!frameInBackbuffer) {
+            if (isFirstFrame) drawFullscreenTexture(*source);
+            else drawBlendedTextures(*source, historyTargets[0], g_RenderSettings.blurStrength, 1.0f / 255.0f);
+        } else if (!isFirstFrame) {
+            compositeHistoryOverBackbuffer(historyTargets[0], g_RenderSettings.blurStrength);
+        }
+        rawCaptured = false;
+        blitFrameToTarget(output, historyTargets[0], width, height);
         isFirstFrame = false;
-    } else {
-        glBindFramebuffer(GL_FRAMEBUFFER, historyFBOs[curr]); glViewport(0, 0, width, height);
-        glUseProgram(blendShaderProgram);
-        glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, rawTexture); glUniform1i(blendCurrentLoc, 0);
-        glActiveTexture(GL_TEXTURE1); glBindTexture(GL_TEXTURE_2D, historyTextures[prev]); glUniform1i(blendHistoryLoc, 1);
-        glUniform1f(blendFactorLoc, blur_strength);
-        glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-        glEnableVertexAttribArray(blendPosLoc); glVertexAttribPointer(blendPosLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
-        glEnableVertexAttribArray(blendTexCoordLoc); glVertexAttribPointer(blendTexCoordLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
-        glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
-    }
-    glBindFramebuffer(GL_FRAMEBUFFER, 0); glViewport(0, 0, width, height); glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
-    glUseProgram(drawShaderProgram); glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, historyTextures[curr]); glUniform1i(drawTextureLoc, 0);
-    glBindBuffer(GL_ARRAY_BUFFER, vertexBuffer); glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
-    glEnableVertexAttribArray(drawPosLoc); glVertexAttribPointer(drawPosLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
-    glEnableVertexAttribArray(drawTexCoordLoc); glVertexAttribPointer(drawTexCoordLoc, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), (void*)(2 * sizeof(GLfloat)));
-    glDrawElements(GL_TRIANGLES, 6, GL_UNSIGNED_SHORT, nullptr);
+        g_BlurTimer.End();
+        return output;
+    }
+
+    if (frameInBackbuffer) {
+        captureDefaultFramebuffer(width, height);
+        source = &rawTarget;
+    }
+
+    int curr = pingPongIndex, prev = 1 - pingPongIndex;
+    glBindFramebuffer(GL_FRAMEBUFFER, historyTargets[curr].fbo); glViewport(0, 0, accumWidth, accumHeight);
+    invalidateDrawFramebuffer(false, true, false);
+    if (isFirstFrame) drawFullscreenTexture(*source);
+    else drawBlendedTextures(*source, historyTargets[prev], g_RenderSettings.blurStrength, historyFormatDither[historyFormat]);
+
+    glBindFramebuffer(GL_FRAMEBUFFER, outputFBO); glViewport(0, 0, width, height);
+    if (output) invalidateDrawFramebuffer(false, true, false);
+    if (!frameInBackbuffer) {
+        if (isFirstFrame) drawFullscreenTexture(*source);
+        else drawBlendedTextures(*source, historyTargets[prev], g_RenderSettings.blurStrength, 1.0f / 255.0f);
+    } else if (!isFirstFrame) {
+        compositeHistoryOverBackbuffer(historyTargets[prev], g_RenderSettings.blurStrength);
+    }
+    isFirstFrame = false;
+    g_BlurTimer.End();
     pingPongIndex = prev;
+    return output;
+}
+
+static bool postEffectsEnabled() {
+    for (bool enabled : g_RenderSettings.postPasses) if (enabled) return true;
+    return false;
+}
+
+// Orders the enabled passes by stage and cuts them into groups that each become a single fullscreen draw. Only a
+// neighbourhood pass that is not already first in its group forces a cut, since it needs its input resolved to a texture.
+static void buildPostGraph() {
+    uint32_t mask = 0;
+    for (int i = 0; i < PostPass_COUNT; i++) if (g_RenderSettings.postPasses[i]) mask |= 1u << i;
+    if (mask == postGraphMask) return;
+    if (postGraphMask == ~0u) {
+        for (int i = 0; i < PostPass_COUNT; i++) {
+            int j = i;
+            for (; j > 0 && postPasses[postPassOrder[j - 1]].stage > postPasses[i].stage; j--) postPassOrder[j] = postPassOrder[j - 1];
+            postPassOrder[j] = i;
+        }
+    }
+    postGraphMask = mask;
+    postGroupMasks.clear();
+    uint32_t group = 0;
+    for (int id : postPassOrder) {
+        if (!(mask & (1u << id))) continue;
+        if (postPasses[id].neighborhood && group != 0) { postGroupMasks.push_back(group); group = 0; }
+        group |= 1u << id;
+    }
+    if (group != 0) postGroupMasks.push_back(group);
+    queryDefaultFramebufferFormat();
+}
+
+static const PostGroup& postGroupProgram(uint32_t mask) {
+    PostGroup& group = postGroupPrograms[mask];
+    if (group.program != 0) return group;
+    std::string source = postFragmentPrologue;
+    for (int id : postPassOrder) if (mask & (1u << id)) source += postPasses[id].declarations;
+    source += "void main() {\n    vec2 uv = vTexCoord;\n    vec3 color = readInput(uv);\n";
+    for (int id : postPassOrder) if (mask & (1u << id)) source += postPasses[id].body;
+    source += "    fragColor = vec4(color, 1.0);\n}\n";
+    group.program = linkProgram(fullscreenVertexShaderSource, source.c_str());
+    if (group.program == 0) return group;
+    glUseProgram(group.program);
+    glUniform1i(glGetUniformLocation(group.program, "uInput"), 0);
+    group.inputRectLoc = glGetUniformLocation(group.program, "uInputRect");
+    group.texelLoc = glGetUniformLocation(group.program, "uTexel");
+    group.sharpenLoc = glGetUniformLocation(group.program, "uSharpen");
+    group.gradeLoc = glGetUniformLocation(group.program, "uGrade");
+    group.vignetteLoc = glGetUniformLocation(group.program, "uVignette");
+    return group;
+}
+
+static void drawPostGroup(uint32_t mask, const RenderTarget& input, int width, int height) {
+    const PostGroup& group = postGroupProgram(mask);
+    if (group.program == 0) { drawFullscreenTexture(input); return; }
+    glUseProgram(group.program); glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, input.texture);
+    setTargetRect(group.inputRectLoc, input);
+    glUniform2f(group.texelLoc, 1.0f / (float)width, 1.0f / (float)height);
+    glUniform1f(group.sharpenLoc, g_RenderSettings.sharpen);
+    glUniform3f(group.gradeLoc, g_RenderSettings.grade[0], g_RenderSettings.grade[1], g_RenderSettings.grade[2]);
+    glUniform1f(group.vignetteLoc, g_RenderSettings.vignette);
+    drawFullscreenTriangle();
 }
 
+// Render graph: motion blur (stateful, never fused) runs first, then the effect groups. Each intermediate frame is dead
+// once the next group has read it, so all transients alias two pooled full-size targets and disabled passes cost nothing.
+// frame is the scene texture in zero-copy mode, or null when the frame is in the backbuffer.
+static void runPostGraph(int width, int height, const RenderTarget* frame) {
+    fullscreenPassCount = 0;
+    initializeBlurPrograms();
+    buildPostGraph();
+    bool hasGroups = !postGroupMasks.empty();
+    if (g_RenderSettings.motionBlur) {
+        const RenderTarget* output = nullptr;
+        if (hasGroups && frame) { acquireRenderTarget(postTargets[0], GL_RGBA8, width, height, false); output = &postTargets[0]; }
+        frame = apply_motion_blur(width, height, frame, output);
+    }
+
+    glDisable(GL_SCISSOR_TEST); glDisable(GL_DEPTH_TEST); glDisable(GL_BLEND);
+    if (!frame && hasGroups) {
+        acquireRenderTarget(postTargets[0], defaultFBMultisampled ? surfaceFormat : GL_RGBA8, width, height, false);
+        glBindFramebuffer(GL_READ_FRAMEBUFFER, 0); glBindFramebuffer(GL_DRAW_FRAMEBUFFER, postTargets[0].fbo);
+        invalidateDrawFramebuffer(false, true, false);
+        glBlitFramebuffer(0, 0, width, height, 0, 0, width, height, GL_COLOR_BUFFER_BIT, GL_NEAREST);
+        fullscreenPassCount++;
+        frame = &postTargets[0];
+    }
+    for (size_t i = 0; frame && i < postGroupMasks.size(); i++) {
+        RenderTarget* output = i + 1 < postGroupMasks.size() ? &postTargets[frame == &postTargets[0] ? 1 : 0] : nullptr;
+        if (output) acquireRenderTarget(*output, GL_RGBA8, width, height, false);
+        glBindFramebuffer(GL_FRAMEBUFFER, output ? output->fbo : 0); glViewport(0, 0, width, height);
+        invalidateDrawFramebuffer(output == nullptr, true, output == nullptr);
+        drawPostGroup(postGroupMasks[i], *frame, width, height);
+        frame = output;
+    }
+    // A frame still in a texture (zero-copy without effects) has to reach the real backbuffer.
+    if (frame) {
+        glBindFramebuffer(GL_FRAMEBUFFER, 0); glViewport(0, 0, width, height);
+        invalidateDrawFramebuffer(true, true, true);
+        drawFullscreenTexture(*frame);
+    }
+    lastFullscreenPasses = fullscreenPassCount;
+}
+
+// Shadow of the GL state the overlay touches. Hooks on the game's entry points keep it current, so SaveGL is a copy and
+// RestoreGL only re-issues what differs, instead of a dozen glGets that can stall the driver. GL state is per context,
+// so the shadow is per thread and reseeded from real queries after every eglMakeCurrent. Texture and sampler are those of
+// unit 0, the one the ImGui backend draws with.
 struct GLState {
-    GLint program, vao, fbo, array_buffer, element_array_buffer, unpack_buffer;
+    GLint program, vao, drawFbo, readFbo, arrayBuffer, unpackBuffer, packBuffer;
     GLint viewport[4], scissor[4];
-    GLboolean blend, scissorTest, depthTest, cullFace;
+    GLint blend, scissorTest, depthTest, cullFace, stencilTest;
+    GLint blendFunc[4], blendEquation[2]; // src/dst RGB, src/dst alpha; RGB, alpha
+    GLint activeTexture, texture, sampler;
 };
 
-static void SaveGL(GLState& s) {
+struct GLShadow { GLState state; bool valid; };
+static thread_local GLShadow t_GL = {};
+static bool g_StateShadowReady = false;
+static int glShadowMismatches = 0;
+// The same hooks tell the ImGui backend which of its cached state groups anyone changed since its last draw on this thread,
+// so with the shadow ready it keeps its cache across frames instead of backing up and re-setting everything.
+static thread_local ImGui_ImplOpenGL3_StateFlags t_ImGuiStale = ImGui_ImplOpenGL3_StateFlags_All;
+
+static void (*orig_glUseProgram)(GLuint) = nullptr;
+static void (*orig_glBindVertexArray)(GLuint) = nullptr;
+static void (*orig_glBindVertexArrayOES)(GLuint) = nullptr;
+static void (*orig_glBindBuffer)(GLenum, GLuint) = nullptr;
+static void (*orig_glViewport)(GLint, GLint, GLsizei, GLsizei) = nullptr;
+static void (*orig_glScissor)(GLint, GLint, GLsizei, GLsizei) = nullptr;
+static void (*orig_glEnable)(GLenum) = nullptr;
+static void (*orig_glDisable)(GLenum) = nullptr;
+static void (*orig_glDeleteBuffers)(GLsizei, const GLuint*) = nullptr;
+static void (*orig_glDeleteFramebuffers)(GLsizei, const GLuint*) = nullptr;
+static void (*orig_glDeleteVertexArrays)(GLsizei, const GLuint*) = nullptr;
+static void (*orig_glBlendFunc)(GLenum, GLenum) = nullptr;
+static void (*orig_glBlendFuncSeparate)(GLenum, GLenum, GLenum, GLenum) = nullptr;
+static void (*orig_glBlendEquation)(GLenum) = nullptr;
+static void (*orig_glBlendEquationSeparate)(GLenum, GLenum) = nullptr;
+static void (*orig_glActiveTexture)(GLenum) = nullptr;
+static void (*orig_glBindTexture)(GLenum, GLuint) = nullptr;
+static void (*orig_glBindSampler)(GLuint, GLuint) = nullptr;
+static void (*orig_glDeleteTextures)(GLsizei, const GLuint*) = nullptr;
+static void (*orig_glDeleteSamplers)(GLsizei, const GLuint*) = nullptr;
+
+static void hook_glBindFramebuffer(GLenum target, GLuint framebuffer) {
+    if (framebuffer == 0 && g_RedirectFBO != 0 && t_IsRenderThread && !g_InRender) framebuffer = g_RedirectFBO;
+    if (target != GL_READ_FRAMEBUFFER) t_GL.state.drawFbo = framebuffer;
+    if (target != GL_DRAW_FRAMEBUFFER) t_GL.state.readFbo = framebuffer;
+    orig_glBindFramebuffer(target, framebuffer);
+}
+
+// While framebuffer 0 is redirected, the game still names the default framebuffer's buffers (GL_COLOR/GL_DEPTH/GL_STENCIL,
+// GL_BACK), which are invalid against the scene FBO; they are translated to its attachments so the calls keep their effect.
+static void (*orig_glInvalidateFramebuffer)(GLenum, GLsizei, const GLenum*) = nullptr;
+static void (*orig_glInvalidateSubFramebuffer)(GLenum, GLsizei, const GLenum*, GLint, GLint, GLsizei, GLsizei) = nullptr;
+static void (*orig_glDrawBuffers)(GLsizei, const GLenum*) = nullptr;
+static void (*orig_glReadBuffer)(GLenum) = nullptr;
+
+static bool redirectedBinding(GLenum target) {
+    GLuint bound = (GLuint)(target == GL_READ_FRAMEBUFFER ? t_GL.state.readFbo : t_GL.state.drawFbo);
+    return g_RedirectFBO != 0 && bound == g_RedirectFBO && t_IsRenderThread && !g_InRender;
+}
+
+static GLenum redirectedAttachment(GLenum buffer) {
+    switch (buffer) {
+        case GL_COLOR: case GL_BACK: return GL_COLOR_ATTACHMENT0;
+        case GL_DEPTH: return GL_DEPTH_ATTACHMENT;
+        case GL_STENCIL: return GL_STENCIL_ATTACHMENT;
+        default: return buffer;
+    }
+}
+
+// Returns the translated list in `out`, or the game's own list when nothing needs translating.
+static const GLenum* redirectedAttachments(GLenum target, GLsizei count, const GLenum* buffers, GLenum (&out)[8]) {
+    if (count <= 0 || count > 8 || !buffers || !redirectedBinding(target)) return buffers;
+    for (GLsizei i = 0; i < count; i++) out[i] = redirectedAttachment(buffers[i]);
+    return out;
+}
+
+static void hook_glInvalidateFramebuffer(GLenum target, GLsizei count, const GLenum* attachments) {
+    GLenum translated[8];
+    orig_glInvalidateFramebuffer(target, count, redirectedAttachments(target, count, attachments, translated));
+}
+
+static void hook_glInvalidateSubFramebuffer(GLenum target, GLsizei count, const GLenum* attachments, GLint x, GLint y, GLsizei w, GLsizei h) {
+    GLenum translated[8];
+    orig_glInvalidateSubFramebuffer(target, count, redirectedAttachments(target, count, attachments, translated), x, y, w, h);
+}
+
+static void hook_glDrawBuffers(GLsizei count, const GLenum* buffers) {
+    GLenum translated[8];
+    orig_glDrawBuffers(count, redirectedAttachments(GL_DRAW_FRAMEBUFFER, count, buffers, translated));
+}
+
+static void hook_glReadBuffer(GLenum src) {
+    orig_glReadBuffer(redirectedBinding(GL_READ_FRAMEBUFFER) ? redirectedAttachment(src) : src);
+}
+
+static void hook_glUseProgram(GLuint program) { t_GL.state.program = program; t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Program; orig_glUseProgram(program); }
+static void hook_glBindVertexArray(GLuint vao) { t_GL.state.vao = vao; t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_VertexArray; orig_glBindVertexArray(vao); }
+static void hook_glBindVertexArrayOES(GLuint vao) { t_GL.state.vao = vao; t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_VertexArray; orig_glBindVertexArrayOES(vao); }
+
+static void hook_glBindBuffer(GLenum target, GLuint buffer) {
+    if (target == GL_ARRAY_BUFFER) t_GL.state.arrayBuffer = buffer;
+    else if (target == GL_PIXEL_UNPACK_BUFFER) t_GL.state.unpackBuffer = buffer;
+    else if (target == GL_PIXEL_PACK_BUFFER) t_GL.state.packBuffer = buffer;
+    if (target == GL_ARRAY_BUFFER || target == GL_ELEMENT_ARRAY_BUFFER) t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_VertexArray;
+    orig_glBindBuffer(target, buffer);
+}
+
+static void hook_glViewport(GLint x, GLint y, GLsizei w, GLsizei h) {
+    GLint* v = t_GL.state.viewport; v[0] = x; v[1] = y; v[2] = w; v[3] = h;
+    t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Viewport;
+    // The game covering its default framebuffer at another size than the cached one means the surface was resized
+    GLuint fbo = (GLuint)t_GL.state.drawFbo;
+    if (x == 0 && y == 0 && (w != g_SurfaceWidth || h != g_SurfaceHeight) && (fbo == 0 || fbo == g_RedirectFBO) && t_IsRenderThread && !g_InRender)
+        g_SurfaceSizeStale.store(true, std::memory_order_relaxed);
+    orig_glViewport(x, y, w, h);
+}
+
+static void hook_glScissor(GLint x, GLint y, GLsizei w, GLsizei h) {
+    GLint* v = t_GL.state.scissor; v[0] = x; v[1] = y; v[2] = w; v[3] = h;
+    t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Scissor;
+    orig_glScissor(x, y, w, h);
+}
+
+static GLint* shadowCapability(GLenum cap) {
+    switch (cap) {
+        case GL_BLEND: return &t_GL.state.blend;
+        case GL_SCISSOR_TEST: return &t_GL.state.scissorTest;
+        case GL_DEPTH_TEST: return &t_GL.state.depthTest;
+        case GL_CULL_FACE: return &t_GL.state.cullFace;
+        case GL_STENCIL_TEST: return &t_GL.state.stencilTest;
+        default: return nullptr;
+    }
+}
+
+static void shadowEnable(GLenum cap, GLint enabled) {
+    GLint* v = shadowCapability(cap);
+    if (!v) return;
+    *v = enabled;
+    t_ImGuiStale |= cap == GL_BLEND ? ImGui_ImplOpenGL3_StateFlags_Blend : ImGui_ImplOpenGL3_StateFlags_Capabilities;
+}
+
+static void hook_glEnable(GLenum cap) { shadowEnable(cap, GL_TRUE); orig_glEnable(cap); }
+static void hook_glDisable(GLenum cap) { shadowEnable(cap, GL_FALSE); orig_glDisable(cap); }
+
+static void shadowBlendFunc(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+    GLint* f = t_GL.state.blendFunc; f[0] = srcRGB; f[1] = dstRGB; f[2] = srcAlpha; f[3] = dstAlpha;
+    t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Blend;
+}
+
+static void shadowBlendEquation(GLenum rgb, GLenum alpha) {
+    t_GL.state.blendEquation[0] = rgb; t_GL.state.blendEquation[1] = alpha;
+    t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Blend;
+}
+
+static void hook_glBlendFunc(GLenum src, GLenum dst) { shadowBlendFunc(src, dst, src, dst); orig_glBlendFunc(src, dst); }
+static void hook_glBlendFuncSeparate(GLenum srcRGB, GLenum dstRGB, GLenum srcAlpha, GLenum dstAlpha) {
+    shadowBlendFunc(srcRGB, dstRGB, srcAlpha, dstAlpha);
+    orig_glBlendFuncSeparate(srcRGB, dstRGB, srcAlpha, dstAlpha);
+}
+static void hook_glBlendEquation(GLenum mode) { shadowBlendEquation(mode, mode); orig_glBlendEquation(mode); }
+static void hook_glBlendEquationSeparate(GLenum rgb, GLenum alpha) { shadowBlendEquation(rgb, alpha); orig_glBlendEquationSeparate(rgb, alpha); }
+
+static void hook_glActiveTexture(GLenum unit) { t_GL.state.activeTexture = unit; t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Texture; orig_glActiveTexture(unit); }
+
+static void hook_glBindTexture(GLenum target, GLuint texture) {
+    // Any unit counts as stale: the worker's shadow is never seeded, so its active unit is not known for sure
+    if (target == GL_TEXTURE_2D && t_GL.state.activeTexture == GL_TEXTURE0) t_GL.state.texture = texture;
+    if (target == GL_TEXTURE_2D) t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Texture;
+    orig_glBindTexture(target, texture);
+}
+
+static void hook_glBindSampler(GLuint unit, GLuint sampler) {
+    if (unit == 0) { t_GL.state.sampler = sampler; t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Texture; }
+    orig_glBindSampler(unit, sampler);
+}
+
+// Deleting a bound object silently rebinds 0, which the shadow has to follow or RestoreGL would bind a dead name.
+static void hook_glDeleteBuffers(GLsizei n, const GLuint* buffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        GLState& s = t_GL.state;
+        if ((GLuint)s.arrayBuffer == buffers[i]) s.arrayBuffer = 0;
+        if ((GLuint)s.unpackBuffer == buffers[i]) s.unpackBuffer = 0;
+        if ((GLuint)s.packBuffer == buffers[i]) s.packBuffer = 0;
+    }
+    t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_VertexArray;
+    orig_glDeleteBuffers(n, buffers);
+}
+
+static void hook_glDeleteFramebuffers(GLsizei n, const GLuint* framebuffers) {
+    for (GLsizei i = 0; i < n; i++) {
+        if ((GLuint)t_GL.state.drawFbo == framebuffers[i]) t_GL.state.drawFbo = 0;
+        if ((GLuint)t_GL.state.readFbo == framebuffers[i]) t_GL.state.readFbo = 0;
+    }
+    orig_glDeleteFramebuffers(n, framebuffers);
+}
+
+static void hook_glDeleteVertexArrays(GLsizei n, const GLuint* arrays) {
+    for (GLsizei i = 0; i < n; i++) if ((GLuint)t_GL.state.vao == arrays[i]) t_GL.state.vao = 0;
+    t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_VertexArray;
+    orig_glDeleteVertexArrays(n, arrays);
+}
+
+static void hook_glDeleteTextures(GLsizei n, const GLuint* textures) {
+    for (GLsizei i = 0; i < n; i++) if ((GLuint)t_GL.state.texture == textures[i]) t_GL.state.texture = 0;
+    t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Texture;
+    orig_glDeleteTextures(n, textures);
+}
+
+static void hook_glDeleteSamplers(GLsizei n, const GLuint* samplers) {
+    for (GLsizei i = 0; i < n; i++) if ((GLuint)t_GL.state.sampler == samplers[i]) t_GL.state.sampler = 0;
+    t_ImGuiStale |= ImGui_ImplOpenGL3_StateFlags_Texture;
+    orig_glDeleteSamplers(n, samplers);
+}
+
+static void QueryGL(GLState& s) {
     glGetIntegerv(GL_CURRENT_PROGRAM, &s.program);
     glGetIntegerv(GL_VERTEX_ARRAY_BINDING, &s.vao);
-    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &s.fbo);
-    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &s.array_buffer);
-    glGetIntegerv(GL_ELEMENT_ARRAY_BUFFER_BINDING, &s.element_array_buffer);
-    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &s.unpack_buffer);
+    glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &s.drawFbo);
+    glGetIntegerv(GL_READ_FRAMEBUFFER_BINDING, &s.readFbo);
+    glGetIntegerv(GL_ARRAY_BUFFER_BINDING, &s.arrayBuffer);
+    glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &s.unpackBuffer);
+    glGetIntegerv(GL_PIXEL_PACK_BUFFER_BINDING, &s.packBuffer);
     glGetIntegerv(GL_VIEWPORT, s.viewport);
     glGetIntegerv(GL_SCISSOR_BOX, s.scissor);
     s.blend = glIsEnabled(GL_BLEND);
     s.scissorTest = glIsEnabled(GL_SCISSOR_TEST);
     s.depthTest = glIsEnabled(GL_DEPTH_TEST);
     s.cullFace = glIsEnabled(GL_CULL_FACE);
+    s.stencilTest = glIsEnabled(GL_STENCIL_TEST);
+    glGetIntegerv(GL_BLEND_SRC_RGB, &s.blendFunc[0]); glGetIntegerv(GL_BLEND_DST_RGB, &s.blendFunc[1]);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &s.blendFunc[2]); glGetIntegerv(GL_BLEND_DST_ALPHA, &s.blendFunc[3]);
+    glGetIntegerv(GL_BLEND_EQUATION_RGB, &s.blendEquation[0]); glGetIntegerv(GL_BLEND_EQUATION_ALPHA, &s.blendEquation[1]);
+    // Unit 0's bindings are read with unit 0 active; `s` may be the shadow itself, which glActiveTexture updates meanwhile
+    GLint active;
+    glGetIntegerv(GL_ACTIVE_TEXTURE, &active);
+    if (active != GL_TEXTURE0) glActiveTexture(GL_TEXTURE0);
+    glGetIntegerv(GL_TEXTURE_BINDING_2D, &s.texture);
+    glGetIntegerv(GL_SAMPLER_BINDING, &s.sampler);
+    if (active != GL_TEXTURE0) glActiveTexture(active);
+    s.activeTexture = active;
+}
+
+// The element buffer binding is not saved: it belongs to the bound VAO, and restoring the VAO restores it.
+static void SaveGL(GLState& s) {
+    if (!g_StateShadowReady) { QueryGL(s); return; }
+    if (!t_GL.valid) { QueryGL(t_GL.state); t_GL.valid = true; }
+    if (g_RenderSettings.shadowVerify) {
+        GLState real;
+        QueryGL(real);
+        if (memcmp(&real, &t_GL.state, sizeof(GLState)) != 0) {
+            glShadowMismatches++;
+            LOGI("GL state shadow mismatch (%d)", glShadowMismatches);
+            t_GL.state = real;
+        }
+    }
+    s = t_GL.state;
 }
 
 static void RestoreGL(const GLState& s) {
-    glUseProgram(s.program);
-    glBindVertexArray(s.vao);
-    glBindBuffer(GL_ARRAY_BUFFER, s.array_buffer);
-    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, s.element_array_buffer);
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.unpack_buffer);
-    glBindFramebuffer(GL_FRAMEBUFFER, s.fbo);
-    glViewport(s.viewport[0], s.viewport[1], s.viewport[2], s.viewport[3]);
-    glScissor(s.scissor[0], s.scissor[1], s.scissor[2], s.scissor[3]);
-    if (s.blend) glEnable(GL_BLEND); else glDisable(GL_BLEND);
-    if (s.scissorTest) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST);
-    if (s.depthTest) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST);
-    if (s.cullFace) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE);
+    const GLState* cur = g_StateShadowReady && t_GL.valid ? &t_GL.state : nullptr;
+    if (!cur || cur->program != s.program) glUseProgram(s.program);
+    if (!cur || cur->vao != s.vao) glBindVertexArray(s.vao);
+    if (!cur || cur->arrayBuffer != s.arrayBuffer) glBindBuffer(GL_ARRAY_BUFFER, s.arrayBuffer);
+    if (!cur || cur->unpackBuffer != s.unpackBuffer) glBindBuffer(GL_PIXEL_UNPACK_BUFFER, s.unpackBuffer);
+    if (!cur || cur->packBuffer != s.packBuffer) glBindBuffer(GL_PIXEL_PACK_BUFFER, s.packBuffer);
+    if (s.drawFbo == s.readFbo) { if (!cur || cur->drawFbo != s.drawFbo || cur->readFbo != s.readFbo) glBindFramebuffer(GL_FRAMEBUFFER, s.drawFbo); }
+    else { glBindFramebuffer(GL_DRAW_FRAMEBUFFER, s.drawFbo); glBindFramebuffer(GL_READ_FRAMEBUFFER, s.readFbo); }
+    if (!cur || memcmp(cur->viewport, s.viewport, sizeof(s.viewport)) != 0) glViewport(s.viewport[0], s.viewport[1], s.viewport[2], s.viewport[3]);
+    if (!cur || memcmp(cur->scissor, s.scissor, sizeof(s.scissor)) != 0) glScissor(s.scissor[0], s.scissor[1], s.scissor[2], s.scissor[3]);
+    if (!cur || cur->blend != s.blend) { if (s.blend) glEnable(GL_BLEND); else glDisable(GL_BLEND); }
+    if (!cur || cur->scissorTest != s.scissorTest) { if (s.scissorTest) glEnable(GL_SCISSOR_TEST); else glDisable(GL_SCISSOR_TEST); }
+    if (!cur || cur->depthTest != s.depthTest) { if (s.depthTest) glEnable(GL_DEPTH_TEST); else glDisable(GL_DEPTH_TEST); }
+    if (!cur || cur->cullFace != s.cullFace) { if (s.cullFace) glEnable(GL_CULL_FACE); else glDisable(GL_CULL_FACE); }
+    if (!cur || cur->stencilTest != s.stencilTest) { if (s.stencilTest) glEnable(GL_STENCIL_TEST); else glDisable(GL_STENCIL_TEST); }
+    if (!cur || memcmp(cur->blendFunc, s.blendFunc, sizeof(s.blendFunc)) != 0) glBlendFuncSeparate(s.blendFunc[0], s.blendFunc[1], s.blendFunc[2], s.blendFunc[3]);
+    if (!cur || memcmp(cur->blendEquation, s.blendEquation, sizeof(s.blendEquation)) != 0) glBlendEquationSeparate(s.blendEquation[0], s.blendEquation[1]);
+    // `cur` follows each call, so unit 0 stays active for the texture bind and the final compare sees it
+    if (!cur || cur->texture != s.texture) { if (!cur || cur->activeTexture != GL_TEXTURE0) glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, s.texture); }
+    if (!cur || cur->sampler != s.sampler) glBindSampler(0, s.sampler);
+    if (!cur || cur->activeTexture != s.activeTexture) glActiveTexture(s.activeTexture);
 }
 
 static void (*initMotionEvent)(void*, void*, void*) = nullptr;
 static void HookInput1(void* thiz, void* a1, void* a2) {
     if (initMotionEvent) initMotionEvent(thiz, a1, a2);
-    if (thiz && g_Initialized) ImGui_ImplAndroid_HandleInputEvent((AInputEvent*)thiz);
+    if (thiz && g_Initialized) { ImGui_ImplAndroid_HandleInputEvent((AInputEvent*)thiz); g_InputSerial.fetch_add(1, std::memory_order_relaxed); }
 }
 
 static int32_t (*Consume)(void*, void*, bool, long, uint32_t*, AInputEvent**) = nullptr;
 static int32_t HookInput2(void* thiz, void* a1, bool a2, long a3, uint32_t* a4, AInputEvent** event) {
     int32_t result = Consume ? Consume(thiz, a1, a2, a3, a4, event) : 0;
-    if (result == 0 && event && *event && g_Initialized) ImGui_ImplAndroid_HandleInputEvent(*event);
+    if (result == 0 && event && *event && g_Initialized) { ImGui_ImplAndroid_HandleInputEvent(*event); g_InputSerial.fetch_add(1, std::memory_order_relaxed); }
     return result;
 }
 
@@ -272,178 +1288,548 @@ static void ScanSignatures() {
     g_PatchesReady = true;
 }
 
-static void DrawMenu() {
-    ImGui::SetNextWindowPos(ImVec2(10, 80), ImGuiCond_FirstUseEver);
-    ImGui::Begin("AnarchyArray Menu", nullptr, ImGuiWindowFlags_AlwaysAutoResize);
-
-    if (ImGui::CollapsingHeader("Minecraft Patches", ImGuiTreeNodeFlags_DefaultOpen)) {
-        static bool infinitySpread = false;
-        static bool spongePlus = false;
-        static bool spongePlusPlus = false;
-        static bool spongeAll = false;
-        static int absorbTypeVal = 5;
-
-        if (ImGui::Checkbox("InfinitySpread", &infinitySpread) && g_PatchesReady) {
-            const uint8_t patch[] = {0x03, 0x00, 0x80, 0x52};
-            for (size_t i = 0; i < 4 && i < g_PatchAddrs.size(); i++) {
-                if (g_PatchAddrs[i] != 0) WriteMemory((void*)g_PatchAddrs[i], infinitySpread ? (void*)patch : (void*)g_Originals[i].data(), 4, true);
-            }
+// Writes the patches whose menu toggle changed since the last call; nothing is written until the signatures are found.
+static void applyMenuPatches() {
+    static PatchSettings applied = {false, false, false, false, -1};
+    const PatchSettings& p = g_PatchSettings;
+    if (!g_PatchesReady) return;
+    if (p.infinitySpread != applied.infinitySpread) {
+        const uint8_t patch[] = {0x03, 0x00, 0x80, 0x52};
+        for (size_t i = 0; i < 4 && i < g_PatchAddrs.size(); i++) {
+            if (g_PatchAddrs[i] != 0) WriteMemory((void*)g_PatchAddrs[i], p.infinitySpread ? (void*)patch : (void*)g_Originals[i].data(), 4, true);
         }
-
-        if (ImGui::Checkbox("SpongeRange+", &spongePlus) && g_PatchesReady) {
-            const uint8_t patchPlus[] = {0x1F, 0x20, 0x03, 0xD5, 0xFB, 0x13, 0x40, 0xF9, 0x7F, 0x07, 0x00, 0xB1};
-            if (4 < g_PatchAddrs.size() && g_PatchAddrs[4] != 0) {
-                WriteMemory((void*)g_PatchAddrs[4], spongePlus ? (void*)patchPlus : (void*)g_Originals[4].data(), spongePlus ? sizeof(patchPlus) : 4, true);
-            }
+    }
+    if (p.spongePlus != applied.spongePlus) {
+        const uint8_t patchPlus[] = {0x1F, 0x20, 0x03, 0xD5, 0xFB, 0x13, 0x40, 0xF9, 0x7F, 0x07, 0x00, 0xB1};
+        if (4 < g_PatchAddrs.size() && g_PatchAddrs[4] != 0) {
+            WriteMemory((void*)g_PatchAddrs[4], p.spongePlus ? (void*)patchPlus : (void*)g_Originals[4].data(), p.spongePlus ? sizeof(patchPlus) : 4, true);
         }
-
-        ImGui::BeginDisabled(!spongePlus);
-        if (ImGui::Checkbox("SpongeRange++", &spongePlusPlus) && g_PatchesReady) {
-            const uint8_t patchPlusPlus[] = {0x5F, 0xFD, 0x03, 0xF1, 0x8B, 0x2D, 0x0D, 0x9B};
-            if (5 < g_PatchAddrs.size() && g_PatchAddrs[5] != 0) {
-                WriteMemory((void*)g_PatchAddrs[5], spongePlusPlus ? (void*)patchPlusPlus : (void*)g_Originals[5].data(), spongePlusPlus ? sizeof(patchPlusPlus) : 4, true);
-            }
+    }
+    if (p.spongePlusPlus != applied.spongePlusPlus) {
+        const uint8_t patchPlusPlus[] = {0x5F, 0xFD, 0x03, 0xF1, 0x8B, 0x2D, 0x0D, 0x9B};
+        if (5 < g_PatchAddrs.size() && g_PatchAddrs[5] != 0) {
+            WriteMemory((void*)g_PatchAddrs[5], p.spongePlusPlus ? (void*)patchPlusPlus : (void*)g_Originals[5].data(), p.spongePlusPlus ? sizeof(patchPlusPlus) : 4, true);
         }
-        ImGui::EndDisabled();
-
-        ImGui::Checkbox("Sponge All", &spongeAll);
-
-        ImGui::BeginDisabled(spongeAll);
-        ImGui::Text("Absorb Type:"); ImGui::SameLine();
-        ImGui::SetNextItemWidth(50);
-        ImGui::InputInt("##absorbDisplay", &absorbTypeVal, 0, 0, ImGuiInputTextFlags_ReadOnly); ImGui::SameLine();
-        
-        ImGui::PushStyleVar(ImGuiStyleVar_FramePadding, ImVec2(6, 6)); ImGui::PushStyleVar(ImGuiStyleVar_ItemSpacing, ImVec2(4, 4));
-        if (ImGui::Button("K", ImVec2(ImGui::GetFrameHeight(), ImGui::GetFrameHeight()))) ImGui::OpenPopup("AbsorbKeypad"); ImGui::SameLine();
-        if (ImGui::Button("i", ImVec2(ImGui::GetFrameHeight(), ImGui::GetFrameHeight()))) ImGui::OpenPopup("AbsorbTypeInfo"); ImGui::SameLine();
-        if (ImGui::Button("-", ImVec2(ImGui::GetFrameHeight(), ImGui::GetFrameHeight())) && absorbTypeVal > 0) absorbTypeVal--; ImGui::SameLine();
-        if (ImGui::Button("+", ImVec2(ImGui::GetFrameHeight(), ImGui::GetFrameHeight())) && absorbTypeVal < 575) absorbTypeVal++;
-        ImGui::PopStyleVar(2);
-        ImGui::EndDisabled();
-
-        if (g_PatchesReady) {
-            for (size_t idx : {6, 7}) {
-                if (idx < g_PatchAddrs.size() && g_PatchAddrs[idx] != 0) {
-                    if (spongeAll) {
-                        uint32_t patchAll = 0x7100003F;
-                        WriteMemory((void*)g_PatchAddrs[idx], &patchAll, 4, true);
-                    } else if (absorbTypeVal >= 0 && absorbTypeVal <= 575) {
-                        uint32_t instr = EncodeCmpW8Imm_Table(absorbTypeVal);
-                        if (instr != 0) WriteMemory((void*)g_PatchAddrs[idx], &instr, 4, true);
-                    }
+    }
+    if (p.spongeAll != applied.spongeAll || (!p.spongeAll && p.absorbType != applied.absorbType)) {
+        for (size_t idx : {6, 7}) {
+            if (idx < g_PatchAddrs.size() && g_PatchAddrs[idx] != 0) {
+                if (p.spongeAll) {
+                    uint32_t patchAll = 0x7100003F;
+                    WriteMemory((void*)g_PatchAddrs[idx], &patchAll, 4, true);
+                } else if (p.absorbType >= 0 && p.absorbType <= 575) {
+                    uint32_t instr = EncodeCmpW8Imm_Table(p.absorbType);
+                    if (instr != 0) WriteMemory((void*)g_PatchAddrs[idx], &instr, 4, true);
                 }
             }
         }
+    }
+    applied = p;
+}
 
-        if (ImGui::BeginPopup("AbsorbTypeInfo", ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize)) {
-            ImGui::Text("0=Air, 1=Dirt, 2=Wood, 5=Water, 6=Lava, 12=TNT...");
-            if (ImGui::Button("Close")) ImGui::CloseCurrentPopup();
-            ImGui::EndPopup();
-        }
+// Pre-rasterized overlay font from tools/bake_font_atlas. It is embedded read-only, so it is mapped along with the library
+// and only the pages of glyphs actually drawn are ever read in.
+#ifdef BAKED_FONT_BLOB
+__asm__(".pushsection .rodata.aa_font_atlas, \"a\"\n.balign 16\n"
+        ".global g_BakedFontBlob\n.hidden g_BakedFontBlob\ng_BakedFontBlob:\n.incbin \"" BAKED_FONT_BLOB "\"\n"
+        ".global g_BakedFontBlobEnd\n.hidden g_BakedFontBlobEnd\ng_BakedFontBlobEnd:\n.popsection");
+extern "C" const uint8_t g_BakedFontBlob[], g_BakedFontBlobEnd[];
+#endif
+static const BakedFontHeader* g_BakedFont = nullptr;
+static ImFontLoader g_BakedFontLoader;
+
+// Baked sizes copy glyphs out of the blob; other sizes, densities and codepoints go through stb_truetype as usual.
+static bool bakedFontBakedInit(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* data) {
+    const BakedFontBucket* match = nullptr;
+    if (baked->Size == ImGui::GetRoundedFontSize(src->SizePixels) && baked->RasterizerDensity == 1.0f && src->RasterizerDensity == 1.0f)
+        for (uint32_t i = 0; i < g_BakedFont->bucketCount; i++) if (bakedFontBuckets(g_BakedFont)[i].sizePixels == baked->Size) match = &bakedFontBuckets(g_BakedFont)[i];
+    *(const BakedFontBucket**)data = match;
+    return ImFontAtlasGetFontLoaderForStbTruetype()->FontBakedInit(atlas, src, baked, nullptr);
+}
 
-        if (ImGui::BeginPopup("AbsorbKeypad", ImGuiWindowFlags_NoResize | ImGuiWindowFlags_AlwaysAutoResize)) {
-            ImGui::Text("Keypad");
-            const float cw = 60.0f, rh = 50.0f;
-            for (int i=1; i<=9; i++) {
-                if (ImGui::Button(std::to_string(i).c_str(), ImVec2(cw, rh))) absorbTypeVal = absorbTypeVal * 10 + i;
-                if (i % 3 != 0) ImGui::SameLine();
-            }
-            ImGui::Dummy(ImVec2(cw, rh)); ImGui::SameLine();
-            if (ImGui::Button("0", ImVec2(cw, rh))) absorbTypeVal = absorbTypeVal * 10; ImGui::SameLine();
-            if (ImGui::Button("<-", ImVec2(cw, rh))) absorbTypeVal /= 10;
-            if (ImGui::Button("Close", ImVec2(cw*3+8, rh/2))) ImGui::CloseCurrentPopup();
-            ImGui::EndPopup();
-        }
-    }
+static bool bakedFontLoadGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* data, ImWchar codepoint, ImFontGlyph* out_glyph, float* out_advance_x) {
+    const BakedFontBucket* bucket = *(const BakedFontBucket**)data;
+    const BakedFontGlyph* glyph = bucket ? bakedFontFindGlyph(g_BakedFont, *bucket, codepoint) : nullptr;
+    if (!glyph) return ImFontAtlasGetFontLoaderForStbTruetype()->FontBakedLoadGlyph(atlas, src, baked, nullptr, codepoint, out_glyph, out_advance_x);
+    if (out_advance_x) { *out_advance_x = glyph->advanceX; return true; }
+    out_glyph->Codepoint = codepoint;
+    out_glyph->AdvanceX = glyph->advanceX;
+    if (glyph->w == 0) return true;
+    ImFontAtlasRectId packId = ImFontAtlasPackAddRect(atlas, glyph->w, glyph->h);
+    if (packId == ImFontAtlasRectId_Invalid) return false;
+    ImTextureRect* r = ImFontAtlasPackGetRect(atlas, packId);
+    out_glyph->X0 = glyph->x0; out_glyph->Y0 = glyph->y0; out_glyph->X1 = glyph->x1; out_glyph->Y1 = glyph->y1;
+    out_glyph->Visible = true;
+    out_glyph->PackId = packId;
+    ImFontAtlasBakedSetFontGlyphBitmap(atlas, baked, src, out_glyph, r, bakedFontPixels(g_BakedFont, *glyph), ImTextureFormat_Alpha8, glyph->w);
+    return true;
+}
 
-    if (ImGui::CollapsingHeader("Visual Effects", ImGuiTreeNodeFlags_DefaultOpen)) {
-        ImGui::Checkbox("Enable Motion Blur", &motion_blur_enabled);
-        if (motion_blur_enabled) {
-            ImGui::Text("Blur Strength");
-            ImGui::SliderFloat("##Strength", &blur_strength, 0.0f, 0.98f, "%.2f");
-        }
+// Returns nullptr (use the atlas' stb_truetype loader) when no blob was built in or it was baked against another ImGui.
+static const ImFontLoader* bakedFontLoader() {
+#ifdef BAKED_FONT_BLOB
+    if (!g_BakedFont) g_BakedFont = bakedFontHeader(g_BakedFontBlob, (size_t)(g_BakedFontBlobEnd - g_BakedFontBlob), IMGUI_VERSION_NUM);
+#endif
+    if (!g_BakedFont) return nullptr;
+    g_BakedFontLoader = *ImFontAtlasGetFontLoaderForStbTruetype();
+    g_BakedFontLoader.Name = "baked + stb_truetype";
+    g_BakedFontLoader.FontBakedInit = bakedFontBakedInit;
+    g_BakedFontLoader.FontBakedLoadGlyph = bakedFontLoadGlyph;
+    g_BakedFontLoader.FontBakedSrcLoaderDataSize = sizeof(const BakedFontBucket*);
+    return &g_BakedFontLoader;
+}
+
+// The overlay font is either glyphs copied from the baked blob at the nearest scale bucket, or one distance-field bake that
+// the backend scales to the exact size. Switching clears the atlas, which rebuilds on the next NewFrame.
+static constexpr float kOverlaySdfFontSize = 32.0f;
+static bool g_OverlayFontSdf = false;
+static float g_OverlayFontScale = kBakedFontScaleMin;
+
+// Glyphs beyond the menu's ASCII (the rest of the default ranges) are rasterized by a few short-lived threads once the
+// font is first used. Until the whole batch is done they draw as the fallback glyph, then the owning thread packs them
+// in queue order before a NewFrame, so the atlas ends up the same as when loading them one by one.
+static constexpr int kGlyphWorkers = 3;
+static ImVector<ImFontGlyphJob> g_GlyphJobs;
+static pthread_t g_GlyphThreads[kGlyphWorkers];
+static int g_GlyphThreadCount = 0;
+static std::atomic<int> g_GlyphNext{0}, g_GlyphDone{0};
+static bool g_GlyphJobsWanted = false;
+
+static void* GlyphWorker(void*) {
+    for (int i; (i = g_GlyphNext.fetch_add(1, std::memory_order_relaxed)) < g_GlyphJobs.Size;) {
+        ImFontAtlasGlyphJobRun(&g_GlyphJobs[i]);
+        g_GlyphDone.fetch_add(1, std::memory_order_release);
     }
+    return nullptr;
+}
+
+static void joinGlyphWorkers() {
+    for (int i = 0; i < g_GlyphThreadCount; i++) pthread_join(g_GlyphThreads[i], nullptr);
+    g_GlyphThreadCount = 0;
+}
+
+// Called after NewFrame, on the baked the menu actually draws with.
+static void queueOverlayGlyphs(ImFontBaked* baked) {
+    g_GlyphJobsWanted = false;
+    if (!g_OverlayFontSdf) for (ImWchar c = 0x20; c <= 0x7E; c++) baked->FindGlyph(c); // Copied from the blob, not worth a thread
+    if (ImFontAtlasGlyphJobsQueue(ImGui::GetIO().Fonts, baked, ImGui::GetIO().Fonts->GetGlyphRangesDefault(), &g_GlyphJobs) == 0) return;
+    g_GlyphNext.store(0); g_GlyphDone.store(0);
+    int workers = std::max(1, std::min(kGlyphWorkers, (int)sysconf(_SC_NPROCESSORS_ONLN) - 1));
+    for (int i = 0; i < workers; i++) if (pthread_create(&g_GlyphThreads[g_GlyphThreadCount], nullptr, GlyphWorker, nullptr) == 0) g_GlyphThreadCount++;
+    if (g_GlyphThreadCount == 0) GlyphWorker(nullptr);
+}
+
+static bool glyphJobsReady() { return !g_GlyphJobs.empty() && g_GlyphDone.load(std::memory_order_acquire) == g_GlyphJobs.Size; }
+
+static void commitGlyphJobs() {
+    if (!glyphJobsReady()) return;
+    joinGlyphWorkers();
+    int jobs = g_GlyphJobs.Size, glyphs = ImFontAtlasGlyphJobsCommit(ImGui::GetIO().Fonts, &g_GlyphJobs);
+    LOGI("Overlay font: %d/%d glyphs rasterized in the background", glyphs, jobs);
+}
+
+// Stops handing out jobs and drops the batch, the atlas must not change while workers read its fonts.
+static void cancelGlyphJobs() {
+    g_GlyphNext.store(g_GlyphJobs.Size);
+    joinGlyphWorkers();
+    ImFontAtlasGlyphJobsClear(ImGui::GetIO().Fonts, &g_GlyphJobs);
+}
 
-    ImGui::End();
+static void loadOverlayFont() {
+    ImGuiIO& io = ImGui::GetIO();
+    cancelGlyphJobs();
+    g_GlyphJobsWanted = true;
+    io.Fonts->ClearFonts();
+    g_OverlayFontSdf = overlay_sdf_font;
+    ImFontConfig cfg;
+    if (g_OverlayFontSdf) {
+        io.Fonts->Flags |= ImFontAtlasFlags_SignedDistanceField;
+        cfg.SizePixels = kOverlaySdfFontSize;
+        ImGui::GetStyle().FontSizeBase = kBakedFontBaseSize * g_OverlayFontScale;
+    } else {
+        io.Fonts->Flags &= ~ImFontAtlasFlags_SignedDistanceField;
+        float bucket = std::max(kBakedFontScaleMin, std::min(std::round(g_OverlayFontScale / kBakedFontScaleStep) * kBakedFontScaleStep, kBakedFontScaleMax));
+        cfg.SizePixels = kBakedFontBaseSize * bucket; cfg.FontLoader = bakedFontLoader();
+        ImGui::GetStyle().FontSizeBase = cfg.SizePixels;
+    }
+    io.Fonts->AddFontDefault(&cfg);
+    LOGI("Overlay font %.1fpx, %s", ImGui::GetStyle().FontSizeBase, g_OverlayFontSdf ? "distance field" : cfg.FontLoader ? "baked" : "rasterized");
 }
 
 static void Setup(ANativeWindow* window) {
     if (g_Initialized || !window) return;
-    ImGui::CreateContext();
-    ImGuiIO& io = ImGui::GetIO();
-    io.IniFilename = nullptr;
-    io.ConfigFlags |= ImGuiConfigFlags_IsTouchScreen;
-    
+    createMenuContext();
+
     float scale = (float)g_Height / 720.0f;
     scale = std::max(1.5f, std::min(scale, 4.0f));
     
-    ImFontConfig cfg; cfg.SizePixels = 18.0f * scale;
-    io.Fonts->AddFontDefault(&cfg);
+    g_OverlayFontScale = scale;
+    loadOverlayFont();
     
     ImGui_ImplAndroid_Init(window);
     ImGui_ImplOpenGL3_Init("#version 300 es");
+    ImGui_ImplOpenGL3_SetProgramCache(loadCachedProgram, storeCachedProgram);
+    // RestoreGL puts the game's state back after the overlay, and the hooks report what the game changes in between
+    if (g_StateShadowReady) ImGui_ImplOpenGL3_SetStateBackup(false);
     ImGui::GetStyle().ScaleAllSizes(scale * 0.65f);
     
     g_Initialized = true;
     LOGI("ImGui Initialized!");
 }
 
+// Idle detection: the ImGui frame is only rebuilt after input, a resize, while a widget is active, during a short settle
+// window after input (hover and popup transitions), and once a second so the live numbers in the menu stay current.
+// With a reduced update rate, rebuilds are further spaced to that rate except for a short full-rate boost after input.
+static constexpr int kOverlaySettleFrames = 30;
+static constexpr double kOverlayIdleRefresh = 1.0, kOverlayBoostSeconds = 0.5;
+static uint32_t g_OverlaySeenSerial = ~0u;
+static int g_OverlaySettle = 0, g_OverlaySeenWidth = 0, g_OverlaySeenHeight = 0;
+static double g_OverlayLastBuild = 0.0, g_OverlayBoostUntil = 0.0;
+static bool g_OverlayBuildIdle = false;
+
+static bool overlayNeedsRebuild(int width, int height) {
+    double now = monotonicSeconds();
+    uint32_t serial = g_InputSerial.load(std::memory_order_relaxed);
+    bool resized = width != g_OverlaySeenWidth || height != g_OverlaySeenHeight;
+    if (serial != g_OverlaySeenSerial) g_OverlayBoostUntil = now + kOverlayBoostSeconds;
+    if (serial != g_OverlaySeenSerial || resized) g_OverlaySettle = kOverlaySettleFrames;
+    g_OverlaySeenSerial = serial; g_OverlaySeenWidth = width; g_OverlaySeenHeight = height;
+    bool rebuild = !overlay_idle_skip || g_OverlaySettle > 0 || ImGui::IsAnyItemActive() || glyphJobsReady() || now - g_OverlayLastBuild >= kOverlayIdleRefresh;
+    int rate = overlayRates[overlay_rate_index];
+    // 10% slack so a 30 Hz rate lands on every second vsync at 60 Hz instead of drifting to every third.
+    bool throttled = rate > 0 && !resized && now < g_OverlayLastBuild + 0.9 / rate && now >= g_OverlayBoostUntil;
+    if (!rebuild || throttled) return false;
+    g_OverlayBuildIdle = g_OverlaySettle == 0 && !ImGui::IsAnyItemActive() && !glyphJobsReady() && !g_GlyphJobsWanted;
+    if (g_OverlaySettle > 0) g_OverlaySettle--;
+    g_OverlayLastBuild = now;
+    return true;
+}
+
+// Without a rebuild the previous frame's draw data, still valid until the next NewFrame, is simply submitted again.
+static void DrawOverlayFrame(int width, int height, bool rebuild) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    glBindVertexArray(0);
+    glDisable(GL_DEPTH_TEST);
+    glDisable(GL_CULL_FACE);
+
+    if (rebuild) {
+        allocFrameEnd();
+        // Past the settle window the menu only redraws what it drew before, so everything it needs is already allocated
+        static bool lastBuildIdle = false, idleAllocReported = false;
+        if (lastBuildIdle && g_AllocLastFrame.calls > 0 && !idleAllocReported) {
+            idleAllocReported = true;
+            LOGI("Overlay: %u allocations (%zu bytes) in an idle frame", g_AllocLastFrame.calls, g_AllocLastFrame.bytes);
+        }
+        lastBuildIdle = g_OverlayBuildIdle;
+        ImGuiIO& io = ImGui::GetIO();
+        if (width > 0 && height > 0) {
+            io.DisplaySize = ImVec2((float)width, (float)height);
+        }
+
+        if (overlay_sdf_font != g_OverlayFontSdf) loadOverlayFont();
+        commitGlyphJobs();
+        ImGui_ImplOpenGL3_NewFrame();
+        ImGui_ImplAndroid_NewFrame(); 
+        ImGui::NewFrame();
+        if (g_GlyphJobsWanted) queueOverlayGlyphs(ImGui::GetFontBaked());
+        
+        g_OverlayDrawStats = ImGui_ImplOpenGL3_GetFrameStats();
+        DrawMenu();
+        applyMenuPatches();
+
+        ImGui::Render();
+    }
+    if (ImDrawData* drawData = ImGui::GetDrawData()) {
+        // Without the hooks nothing reports what changed since the last draw, so nothing cached is trusted
+        ImGui_ImplOpenGL3_InvalidateState(g_StateShadowReady ? t_ImGuiStale : ImGui_ImplOpenGL3_StateFlags_All);
+        ImGui_ImplOpenGL3_RenderDrawData(drawData);
+        t_ImGuiStale = ImGui_ImplOpenGL3_StateFlags_None; // what the backend just set itself went through the hooks too
+    }
+}
+
+// Premultiplied composite of an overlay texture over the backbuffer, on the game's context.
+static void compositeOverlayTexture(const RenderTarget& overlay, int width, int height) {
+    initializeBlurPrograms();
+    glBindFramebuffer(GL_FRAMEBUFFER, 0); glViewport(0, 0, width, height);
+    glDisable(GL_SCISSOR_TEST); glDisable(GL_DEPTH_TEST);
+    BlendState blend;
+    saveBlendState(blend);
+    glEnable(GL_BLEND); glBlendEquation(GL_FUNC_ADD); glBlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
+    glUseProgram(overlayCompositeProgram); glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D, overlay.texture);
+    setTargetRect(overlayRectLoc, overlay);
+    drawFullscreenTriangle();
+    glBindTexture(GL_TEXTURE_2D, 0);
+    restoreBlendState(blend);
+}
+
+// Reduced update rate on the game's context: ImGui renders into a pooled texture only when a rebuild is due, and every
+// game frame just composites it.
+static void DrawOverlayViaTexture(int width, int height, bool rebuild) {
+    if (acquireRenderTarget(overlayTarget, GL_RGBA8, width, height, false) || rebuild) {
+        glBindFramebuffer(GL_FRAMEBUFFER, overlayTarget.fbo);
+        glViewport(0, 0, width, height);
+        glDisable(GL_SCISSOR_TEST);
+        glClearColor(0.0f, 0.0f, 0.0f, 0.0f); glClear(GL_COLOR_BUFFER_BIT);
+        DrawOverlayFrame(width, height, rebuild);
+    }
+    compositeOverlayTexture(overlayTarget, width, height);
+}
+
+// Separate overlay context: a worker thread owns a context shared with the game's and renders ImGui into a texture, so the
+// game's context only sees one composite draw. Three slots let the worker fill one while the game reads another; the
+// worker's fence orders the composite after the overlay draw, and the game's fence gates reuse of the slot it read.
+struct OverlaySlot { RenderTarget target; GLsync writeFence, readFence; };
+static OverlaySlot g_OverlaySlots[3] = {};
+static int g_OverlayPublished = -1, g_OverlayReading = -1;
+static bool g_OverlayFrameRequested = false, g_OverlayStop = false, g_OverlayFailed = false;
+static bool g_OverlayRunning = false;
+static pthread_t g_OverlayThread;
+static pthread_mutex_t g_OverlayMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t g_OverlayCond = PTHREAD_COND_INITIALIZER;
+static RenderSettings g_OverlaySettings;
+// What the render thread posts with each frame request; the worker uses this copy, never g_Width/g_Height or its clock.
+struct OverlayRequest { int width, height; double frameTime; };
+static OverlayRequest g_OverlayRequest = {};
+static RenderStats g_OverlayStats;
+static EGLDisplay g_OverlayDisplay = EGL_NO_DISPLAY;
+static EGLContext g_OverlayShareContext = EGL_NO_CONTEXT;
+
+// Uses the game context's own config; surfaceless where supported, otherwise a 1x1 pbuffer.
+static EGLContext createOverlayContext(EGLSurface& pbuffer) {
+    EGLint configId = 0, count = 0;
+    EGLConfig config = nullptr;
+    eglQueryContext(g_OverlayDisplay, g_OverlayShareContext, EGL_CONFIG_ID, &configId);
+    const EGLint configAttribs[] = {EGL_CONFIG_ID, configId, EGL_NONE};
+    if (!eglChooseConfig(g_OverlayDisplay, configAttribs, &config, 1, &count) || count == 0) return EGL_NO_CONTEXT;
+    const EGLint contextAttribs[] = {EGL_CONTEXT_CLIENT_VERSION, 3, EGL_NONE};
+    EGLContext ctx = eglCreateContext(g_OverlayDisplay, config, g_OverlayShareContext, contextAttribs);
+    if (ctx == EGL_NO_CONTEXT) return EGL_NO_CONTEXT;
+
+    pbuffer = EGL_NO_SURFACE;
+    const char* exts = eglQueryString(g_OverlayDisplay, EGL_EXTENSIONS);
+    if (!exts || !strstr(exts, "EGL_KHR_surfaceless_context")) {
+        const EGLint pbufferAttribs[] = {EGL_WIDTH, 1, EGL_HEIGHT, 1, EGL_NONE};
+        pbuffer = eglCreatePbufferSurface(g_OverlayDisplay, config, pbufferAttribs);
+    }
+    if (!eglMakeCurrent(g_OverlayDisplay, pbuffer, pbuffer, ctx)) {
+        if (pbuffer != EGL_NO_SURFACE) eglDestroySurface(g_OverlayDisplay, pbuffer);
+        eglDestroyContext(g_OverlayDisplay, ctx);
+        return EGL_NO_CONTEXT;
+    }
+    return ctx;
+}
+
+static void renderOverlaySlot(OverlaySlot& slot, int width, int height) {
+    acquireRenderTarget(slot.target, GL_RGBA8, width, height, false);
+    glBindFramebuffer(GL_FRAMEBUFFER, slot.target.fbo);
+    glViewport(0, 0, width, height);
+    glDisable(GL_SCISSOR_TEST);
+    glClearColor(0.0f, 0.0f, 0.0f, 0.0f); glClear(GL_COLOR_BUFFER_BIT);
+    DrawOverlayFrame(width, height, true);
+}
+
+static void* OverlayThread(void*) {
+    EGLSurface pbuffer = EGL_NO_SURFACE;
+    EGLContext ctx = createOverlayContext(pbuffer);
+    if (ctx == EGL_NO_CONTEXT) {
+        LOGI("Overlay context creation failed");
+        pthread_mutex_lock(&g_OverlayMutex); g_OverlayFailed = true; pthread_mutex_unlock(&g_OverlayMutex);
+        return nullptr;
+    }
+    ImGui_ImplOpenGL3_Init("#version 300 es");
+    ImGui_ImplOpenGL3_SetProgramCache(loadCachedProgram, storeCachedProgram);
+    // Nothing else draws on this context, so the backend's state survives between frames and needs no backup.
+    ImGui_ImplOpenGL3_SetStateBackup(false);
+
+    for (;;) {
+        pthread_mutex_lock(&g_OverlayMutex);
+        while (!g_OverlayFrameRequested && !g_OverlayStop) pthread_cond_wait(&g_OverlayCond, &g_OverlayMutex);
+        if (g_OverlayStop) { pthread_mutex_unlock(&g_OverlayMutex); break; }
+        g_OverlayFrameRequested = false;
+        g_MenuStats = g_OverlayStats;
+        OverlayRequest request = g_OverlayRequest;
+        // An idle frame publishes nothing, so the game keeps compositing the cached texture.
+        if (!overlayNeedsRebuild(request.width, request.height)) { pthread_mutex_unlock(&g_OverlayMutex); continue; }
+        int index = 0;
+        while (index == g_OverlayPublished || index == g_OverlayReading) index++;
+        OverlaySlot& slot = g_OverlaySlots[index];
+        GLsync readFence = slot.readFence; slot.readFence = nullptr;
+        pthread_mutex_unlock(&g_OverlayMutex);
+        t_FrameTime = request.frameTime;
+
+        if (readFence) { glWaitSync(readFence, 0, GL_TIMEOUT_IGNORED); glDeleteSync(readFence); }
+        if (slot.writeFence) { glDeleteSync(slot.writeFence); slot.writeFence = nullptr; }
+        renderOverlaySlot(slot, request.width, request.height);
+        slot.writeFence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        glFlush();
+
+        RenderSettings settings = captureRenderSettings();
+        pthread_mutex_lock(&g_OverlayMutex); g_OverlayPublished = index; g_OverlaySettings = settings; pthread_mutex_unlock(&g_OverlayMutex);
+    }
+
+    ImGui_ImplOpenGL3_Shutdown();
+    for (OverlaySlot& slot : g_OverlaySlots) {
+        releaseRenderTarget(slot.target);
+        if (slot.writeFence) glDeleteSync(slot.writeFence);
+        if (slot.readFence) glDeleteSync(slot.readFence);
+        slot = OverlaySlot();
+    }
+    pthread_mutex_lock(&g_OverlayMutex); g_OverlayPublished = g_OverlayReading = -1; pthread_mutex_unlock(&g_OverlayMutex);
+    eglMakeCurrent(g_OverlayDisplay, EGL_NO_SURFACE, EGL_NO_SURFACE, EGL_NO_CONTEXT);
+    if (pbuffer != EGL_NO_SURFACE) eglDestroySurface(g_OverlayDisplay, pbuffer);
+    eglDestroyContext(g_OverlayDisplay, ctx);
+    return nullptr;
+}
+
+static RenderStats captureRenderStats() {
+    return {historyTargets[0].fbo != 0 ? historyFormat : -1, lastFullscreenPasses, glShadowMismatches, staticFrames >= 2, orig_glBindFramebuffer != nullptr,
+            g_StateShadowReady, frameDifference, g_BlurTimer.supported ? g_BlurTimer.avgMs : -1.0f, renderTargetPoolBytes()};
+}
+
+// Refreshes g_RenderSettings, then moves the ImGui renderer backend between the game's context and the overlay thread when the
+// setting changed or the worker failed; runs on the game's render thread.
+static void updateOverlayMode() {
+    bool failed = false;
+    if (g_OverlayRunning) {
+        pthread_mutex_lock(&g_OverlayMutex); g_RenderSettings = g_OverlaySettings; failed = g_OverlayFailed; pthread_mutex_unlock(&g_OverlayMutex);
+    } else {
+        g_RenderSettings = captureRenderSettings();
+    }
+    bool wanted = g_RenderSettings.sharedContext && !failed;
+    if (wanted == g_OverlayRunning) return;
+    g_OverlaySeenSerial = ~0u;
+    if (wanted) {
+        ImGui_ImplOpenGL3_Shutdown();
+        g_OverlayDisplay = eglGetCurrentDisplay(); g_OverlayShareContext = eglGetCurrentContext();
+        g_OverlaySettings = g_RenderSettings; g_OverlayStats = captureRenderStats();
+        g_OverlayStop = g_OverlayFailed = false; g_OverlayFrameRequested = true;
+        g_OverlayRequest = {g_Width, g_Height, monotonicSeconds()};
+        pthread_create(&g_OverlayThread, nullptr, OverlayThread, nullptr);
+        g_OverlayRunning = true;
+    } else {
+        pthread_mutex_lock(&g_OverlayMutex); g_OverlayStop = true; pthread_cond_signal(&g_OverlayCond); pthread_mutex_unlock(&g_OverlayMutex);
+        pthread_join(g_OverlayThread, nullptr);
+        g_OverlayRunning = false;
+        // The menu is back on this thread, so its globals are ours again
+        if (failed) overlay_shared_context = g_RenderSettings.sharedContext = false;
+        ImGui_ImplOpenGL3_Init("#version 300 es");
+        ImGui_ImplOpenGL3_SetProgramCache(loadCachedProgram, storeCachedProgram);
+        if (g_StateShadowReady) ImGui_ImplOpenGL3_SetStateBackup(false);
+    }
+}
+
+static void compositeOverlay(int width, int height) {
+    pthread_mutex_lock(&g_OverlayMutex);
+    int index = g_OverlayPublished;
+    if (index >= 0) g_OverlayReading = index;
+    GLsync writeFence = index >= 0 ? g_OverlaySlots[index].writeFence : nullptr;
+    RenderTarget overlay = index >= 0 ? g_OverlaySlots[index].target : RenderTarget();
+    pthread_mutex_unlock(&g_OverlayMutex);
+
+    if (index >= 0) {
+        glWaitSync(writeFence, 0, GL_TIMEOUT_IGNORED);
+        compositeOverlayTexture(overlay, width, height);
+    }
+    GLsync readFence = index >= 0 ? glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) : nullptr;
+    RenderStats stats = captureRenderStats();
+
+    pthread_mutex_lock(&g_OverlayMutex);
+    g_OverlayStats = stats;
+    GLsync oldFence = nullptr;
+    if (index >= 0) { oldFence = g_OverlaySlots[index].readFence; g_OverlaySlots[index].readFence = readFence; }
+    g_OverlayRequest = {width, height, t_FrameTime};
+    g_OverlayFrameRequested = true;
+    pthread_cond_signal(&g_OverlayCond);
+    pthread_mutex_unlock(&g_OverlayMutex);
+    if (oldFence) glDeleteSync(oldFence);
+}
+
 static void Render() {
     if (!g_Initialized) return;
 
+    updateOverlayMode();
+    g_InRender = true;
+    t_FrameTime = monotonicSeconds();
     GLState state;
     SaveGL(state);
 
-    if (motion_blur_enabled) {
-        apply_motion_blur(g_Width, g_Height);
-        glBindFramebuffer(GL_FRAMEBUFFER, state.fbo);
+    GLuint redirectedFBO = g_RedirectFBO;
+    bool postActive = g_RenderSettings.motionBlur || postEffectsEnabled();
+    if (redirectedFBO != 0 || postActive) {
+        if (redirectedFBO != 0) {
+            glBindFramebuffer(GL_FRAMEBUFFER, redirectedFBO);
+            invalidateDrawFramebuffer(false, false, true);
+        }
+        runPostGraph(g_Width, g_Height, redirectedFBO != 0 ? &sceneTarget : nullptr);
+        if (redirectedFBO != 0) {
+            glBindFramebuffer(GL_FRAMEBUFFER, redirectedFBO);
+            invalidateDrawFramebuffer(false, true, false);
+        }
+        glBindFramebuffer(GL_FRAMEBUFFER, (GLuint)state.drawFbo == redirectedFBO ? 0 : state.drawFbo);
+    } else {
+        lastFullscreenPasses = 0;
     }
 
-    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
-    glBindVertexArray(0);
-    glDisable(GL_DEPTH_TEST);
-    glDisable(GL_CULL_FACE);
+    if (!g_OverlayRunning) g_MenuStats = captureRenderStats();
+    if (g_OverlayRunning) compositeOverlay(g_Width, g_Height);
+    else if (overlayRates[overlay_rate_index] > 0) DrawOverlayViaTexture(g_Width, g_Height, overlayNeedsRebuild(g_Width, g_Height));
+    else DrawOverlayFrame(g_Width, g_Height, overlayNeedsRebuild(g_Width, g_Height));
 
-    ImGuiIO& io = ImGui::GetIO();
-    if (g_Width > 0 && g_Height > 0) {
-        io.DisplaySize = ImVec2((float)g_Width, (float)g_Height);
+    // Zero-copy mode: the game's binds of framebuffer 0 land in the scene target, so the frame is already in a sampleable texture at swap time.
+    if (postActive && g_RenderSettings.zeroCopy && orig_glBindFramebuffer) {
+        acquireRenderTarget(sceneTarget, GL_RGBA8, g_Width, g_Height, true);
+        g_RedirectFBO = sceneTarget.fbo;
+    } else {
+        g_RedirectFBO = 0;
     }
-
-    ImGui_ImplOpenGL3_NewFrame();
-    ImGui_ImplAndroid_NewFrame(); 
-    ImGui::NewFrame();
-    
-    DrawMenu();
-    
-    ImGui::Render();
-    ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+    releaseIdleRenderTargets();
 
     RestoreGL(state);
+    if (state.drawFbo == 0 || (GLuint)state.drawFbo == redirectedFBO) glBindFramebuffer(GL_FRAMEBUFFER, g_RedirectFBO);
+    g_InRender = false;
 }
 
 static EGLSurface hook_eglCreateWindowSurface(EGLDisplay dpy, EGLConfig config, EGLNativeWindowType win, const EGLint* attrib_list) {
-    if (win) g_Window = (ANativeWindow*)win;
-    return orig_eglCreateWindowSurface(dpy, config, win, attrib_list);
+    EGLSurface surface = orig_eglCreateWindowSurface(dpy, config, win, attrib_list);
+    if (win && surface != EGL_NO_SURFACE) {
+        g_Window = (ANativeWindow*)win; g_WindowSurface = surface;
+        eglQuerySurface(dpy, surface, EGL_WIDTH, &g_SurfaceWidth);
+        eglQuerySurface(dpy, surface, EGL_HEIGHT, &g_SurfaceHeight);
+        g_SurfaceSizeStale.store(false, std::memory_order_relaxed);
+    }
+    return surface;
 }
 
 static ANativeWindow* hook_ANativeWindow_fromSurface(JNIEnv* env, jobject surface) {
     ANativeWindow* win = orig_ANativeWindow_fromSurface(env, surface);
-    if (win) g_Window = win;
+    if (win) { g_Window = win; g_SurfaceSizeStale.store(true, std::memory_order_relaxed); } // a new or resized Surface from Java
     return win;
 }
 
 static EGLBoolean hook_eglMakeCurrent(EGLDisplay dpy, EGLSurface draw, EGLSurface read, EGLContext ctx) {
+    t_GL.valid = false; t_ImGuiStale = ImGui_ImplOpenGL3_StateFlags_All;
     return orig_eglMakeCurrent(dpy, draw, read, ctx);
 }
 
+// The game's window surface uses the size cached at creation. eglQuerySurface runs again only once a resize was seen: a new
+// Surface from Java, or the game viewporting its default framebuffer at another size. The surface itself only takes the new
+// size at a swap, which the window's own size runs ahead of mid-resize. Any other surface is always queried.
+static void updateSurfaceSize(EGLDisplay dpy, EGLSurface surf) {
+    bool window = surf == g_WindowSurface;
+    if (window && !g_SurfaceSizeStale.exchange(false, std::memory_order_relaxed)) { g_Width = g_SurfaceWidth; g_Height = g_SurfaceHeight; return; }
+    eglQuerySurface(dpy, surf, EGL_WIDTH, &g_Width);
+    eglQuerySurface(dpy, surf, EGL_HEIGHT, &g_Height);
+    if (window) { g_SurfaceWidth = g_Width; g_SurfaceHeight = g_Height; }
+}
+
 static EGLBoolean hook_eglSwapBuffers(EGLDisplay dpy, EGLSurface surf) {
     if (!orig_eglSwapBuffers) return EGL_FALSE;
     EGLContext ctx = eglGetCurrentContext();
     
     if (ctx != EGL_NO_CONTEXT && surf != EGL_NO_SURFACE) {
-        eglQuerySurface(dpy, surf, EGL_WIDTH, &g_Width);
-        eglQuerySurface(dpy, surf, EGL_HEIGHT, &g_Height);
-        
+        t_IsRenderThread = true;
+        updateSurfaceSize(dpy, surf);
+
         if (!g_Initialized && g_Window && g_Width > 0 && g_Height > 0) {
             Setup(g_Window);
         }
@@ -454,6 +1840,51 @@ static EGLBoolean hook_eglSwapBuffers(EGLDisplay dpy, EGLSurface surf) {
     return orig_eglSwapBuffers(dpy, surf);
 }
 
+static bool HookGLFunction(const char* name, void* replacement, void** original) {
+    void* hooked = nullptr;
+    for (const char* lib : {"libGLESv3.so", "libGLESv2.so"}) {
+        GHandle h = GlossOpen(lib);
+        void* f = h ? (void*)GlossSymbol(h, name, nullptr) : nullptr;
+        if (!f || f == hooked) continue;
+        if (!hooked) GlossHook(f, replacement, original);
+        else { void* unused = nullptr; GlossHook(f, replacement, &unused); }
+        hooked = f;
+    }
+    return hooked != nullptr;
+}
+
+// The shadow is only trusted once every entry point that can change it is hooked; otherwise SaveGL keeps querying.
+static void HookGLState() {
+    HookGLFunction("glBindFramebuffer", (void*)hook_glBindFramebuffer, (void**)&orig_glBindFramebuffer);
+    bool ready = orig_glBindFramebuffer != nullptr;
+    // Needed for the redirect only, so they don't gate the shadow
+    HookGLFunction("glInvalidateFramebuffer", (void*)hook_glInvalidateFramebuffer, (void**)&orig_glInvalidateFramebuffer);
+    HookGLFunction("glInvalidateSubFramebuffer", (void*)hook_glInvalidateSubFramebuffer, (void**)&orig_glInvalidateSubFramebuffer);
+    HookGLFunction("glDrawBuffers", (void*)hook_glDrawBuffers, (void**)&orig_glDrawBuffers);
+    HookGLFunction("glReadBuffer", (void*)hook_glReadBuffer, (void**)&orig_glReadBuffer);
+    ready &= HookGLFunction("glUseProgram", (void*)hook_glUseProgram, (void**)&orig_glUseProgram);
+    ready &= HookGLFunction("glBindVertexArray", (void*)hook_glBindVertexArray, (void**)&orig_glBindVertexArray);
+    ready &= HookGLFunction("glBindBuffer", (void*)hook_glBindBuffer, (void**)&orig_glBindBuffer);
+    ready &= HookGLFunction("glViewport", (void*)hook_glViewport, (void**)&orig_glViewport);
+    ready &= HookGLFunction("glScissor", (void*)hook_glScissor, (void**)&orig_glScissor);
+    ready &= HookGLFunction("glEnable", (void*)hook_glEnable, (void**)&orig_glEnable);
+    ready &= HookGLFunction("glDisable", (void*)hook_glDisable, (void**)&orig_glDisable);
+    ready &= HookGLFunction("glDeleteBuffers", (void*)hook_glDeleteBuffers, (void**)&orig_glDeleteBuffers);
+    ready &= HookGLFunction("glDeleteFramebuffers", (void*)hook_glDeleteFramebuffers, (void**)&orig_glDeleteFramebuffers);
+    ready &= HookGLFunction("glDeleteVertexArrays", (void*)hook_glDeleteVertexArrays, (void**)&orig_glDeleteVertexArrays);
+    ready &= HookGLFunction("glBlendFunc", (void*)hook_glBlendFunc, (void**)&orig_glBlendFunc);
+    ready &= HookGLFunction("glBlendFuncSeparate", (void*)hook_glBlendFuncSeparate, (void**)&orig_glBlendFuncSeparate);
+    ready &= HookGLFunction("glBlendEquation", (void*)hook_glBlendEquation, (void**)&orig_glBlendEquation);
+    ready &= HookGLFunction("glBlendEquationSeparate", (void*)hook_glBlendEquationSeparate, (void**)&orig_glBlendEquationSeparate);
+    ready &= HookGLFunction("glActiveTexture", (void*)hook_glActiveTexture, (void**)&orig_glActiveTexture);
+    ready &= HookGLFunction("glBindTexture", (void*)hook_glBindTexture, (void**)&orig_glBindTexture);
+    ready &= HookGLFunction("glBindSampler", (void*)hook_glBindSampler, (void**)&orig_glBindSampler);
+    ready &= HookGLFunction("glDeleteTextures", (void*)hook_glDeleteTextures, (void**)&orig_glDeleteTextures);
+    ready &= HookGLFunction("glDeleteSamplers", (void*)hook_glDeleteSamplers, (void**)&orig_glDeleteSamplers);
+    HookGLFunction("glBindVertexArrayOES", (void*)hook_glBindVertexArrayOES, (void**)&orig_glBindVertexArrayOES);
+    g_StateShadowReady = ready;
+}
+
 static void HookInput() {
     void* sym1 = (void*)GlossSymbol(GlossOpen("libinput.so"), "_ZN7android13InputConsumer21initializeMotionEventEPNS_11MotionEventEPKNS_12InputMessageE", nullptr);
     if (sym1) GlossHook(sym1, (void*)HookInput1, (void**)&initMotionEvent);
@@ -464,6 +1895,8 @@ static void HookInput() {
 
 static void* MainThread(void*) {
     GlossInit(true);
+    // Before the swap hook, so Setup already knows whether the shadow can stand in for the backend's state backup
+    HookGLState();
     
     GHandle hEGL = GlossOpen("libEGL.so");
     if (hEGL) {
@@ -0,0 +1,97 @@
+// Host tool: rasterizes the overlay font once for every scale bucket and writes the glyphs to a blob (see src/BakedFont.h)
+// that the library embeds, so the first overlay frames copy pixels instead of running stb_truetype.
+// Usage: bake_font_atlas <output.bin>
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "BakedFont.h"
+
+struct RecordedGlyph { BakedFontGlyph glyph; std::vector<uint8_t> pixels; };
+static std::vector<float> g_BucketSizes;
+static std::vector<std::vector<RecordedGlyph>> g_Buckets;
+static ImFontLoader g_RecordingLoader;
+
+// Same as stb_truetype, but copies each glyph as the loader produced it, before the atlas applies spacing/snapping on top.
+// Every load at a bucket size is recorded, including the ones ImGui makes on its own (e.g. the implicit Debug window's title
+// during NewFrame), since a glyph is only loaded once per baked size.
+static bool recordGlyph(ImFontAtlas* atlas, ImFontConfig* src, ImFontBaked* baked, void* data, ImWchar codepoint, ImFontGlyph* out_glyph, float* out_advance_x) {
+    if (!ImFontAtlasGetFontLoaderForStbTruetype()->FontBakedLoadGlyph(atlas, src, baked, data, codepoint, out_glyph, out_advance_x)) return false;
+    auto bucket = std::find(g_BucketSizes.begin(), g_BucketSizes.end(), baked->Size);
+    if (!out_glyph || bucket == g_BucketSizes.end() || baked->RasterizerDensity != 1.0f || ImGui::GetRoundedFontSize(src->SizePixels) != baked->Size) return true;
+    RecordedGlyph rec = {};
+    rec.glyph = { codepoint, 0, 0, out_glyph->X0, out_glyph->Y0, out_glyph->X1, out_glyph->Y1, out_glyph->AdvanceX, 0 };
+    if (out_glyph->PackId != ImFontAtlasRectId_Invalid) {
+        ImTextureRect* r = ImFontAtlasPackGetRect(atlas, out_glyph->PackId);
+        ImTextureData* tex = atlas->TexData;
+        rec.glyph.w = r->w; rec.glyph.h = r->h;
+        for (int y = 0; y < r->h; y++) { const uint8_t* row = (const uint8_t*)tex->GetPixelsAt(r->x, r->y + y); rec.pixels.insert(rec.pixels.end(), row, row + r->w); }
+    }
+    g_Buckets[bucket - g_BucketSizes.begin()].push_back(rec);
+    return true;
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) { fprintf(stderr, "usage: %s <output.bin>\n", argv[0]); return 1; }
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+    io.Fonts->TexDesiredFormat = ImTextureFormat_Alpha8;
+    g_RecordingLoader = *ImFontAtlasGetFontLoaderForStbTruetype();
+    g_RecordingLoader.Name = "stb_truetype (recording)";
+    g_RecordingLoader.FontBakedLoadGlyph = recordGlyph;
+
+    // Fonts are configured exactly like Setup() does, so baked sizes and glyph offsets match the runtime ones. Buckets are keyed
+    // by the size ImGui actually bakes at, which rounds the half-pixel steps.
+    std::vector<float>& sizes = g_BucketSizes;
+    std::vector<ImFont*> fonts;
+    for (float scale = kBakedFontScaleMin; scale <= kBakedFontScaleMax + 0.001f; scale += kBakedFontScaleStep) {
+        ImFontConfig cfg; cfg.SizePixels = kBakedFontBaseSize * scale; cfg.FontLoader = &g_RecordingLoader;
+        sizes.push_back(ImGui::GetRoundedFontSize(cfg.SizePixels));
+        fonts.push_back(io.Fonts->AddFontDefault(&cfg));
+    }
+    std::vector<std::vector<RecordedGlyph>>& buckets = g_Buckets;
+    buckets.resize(sizes.size());
+    ImGui::NewFrame();
+
+    for (size_t i = 0; i < sizes.size(); i++) {
+        ImFontBaked* baked = fonts[i]->GetFontBaked(sizes[i], 1.0f);
+        for (unsigned c = 0x20; c <= 0x7E; c++) baked->FindGlyphNoFallback((ImWchar)c); // The menu is ASCII, anything else is rare enough to rasterize live
+        baked->FindGlyphNoFallback((ImWchar)0x0085); // Ellipsis
+    }
+    ImGui::EndFrame();
+    for (auto& bucket : buckets) std::sort(bucket.begin(), bucket.end(), [](const RecordedGlyph& a, const RecordedGlyph& b) { return a.glyph.codepoint < b.glyph.codepoint; });
+    ImGui::DestroyContext();
+
+    BakedFontHeader header = { kBakedFontMagic, kBakedFontVersion, IMGUI_VERSION_NUM, (uint32_t)sizes.size() };
+    std::vector<BakedFontBucket> bucketTable(sizes.size());
+    std::vector<uint8_t> pixels;
+    size_t glyphTotal = 0;
+    for (auto& bucket : buckets) glyphTotal += bucket.size();
+    uint32_t glyphOffset = sizeof(header) + sizeof(BakedFontBucket) * bucketTable.size();
+    uint32_t pixelBase = glyphOffset + sizeof(BakedFontGlyph) * glyphTotal;
+    std::vector<BakedFontGlyph> glyphs;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        bucketTable[i] = { sizes[i], (uint32_t)buckets[i].size(), glyphOffset + (uint32_t)(glyphs.size() * sizeof(BakedFontGlyph)), 0 };
+        for (RecordedGlyph& rec : buckets[i]) {
+            rec.glyph.pixelOffset = pixelBase + (uint32_t)pixels.size();
+            pixels.insert(pixels.end(), rec.pixels.begin(), rec.pixels.end());
+            glyphs.push_back(rec.glyph);
+        }
+    }
+
+    FILE* f = fopen(argv[1], "wb");
+    if (!f) { perror(argv[1]); return 1; }
+    bool ok = fwrite(&header, sizeof(header), 1, f) == 1;
+    ok &= fwrite(bucketTable.data(), sizeof(BakedFontBucket), bucketTable.size(), f) == bucketTable.size();
+    ok &= fwrite(glyphs.data(), sizeof(BakedFontGlyph), glyphs.size(), f) == glyphs.size();
+    ok &= fwrite(pixels.data(), 1, pixels.size(), f) == pixels.size();
+    ok &= fclose(f) == 0;
+    if (!ok) { fprintf(stderr, "%s: write failed\n", argv[1]); return 1; }
+    printf("%s: %zu sizes, %zu glyphs, %zu bytes of pixels\n", argv[1], sizes.size(), glyphs.size(), pixels.size());
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Host microbenchmark for the ID hash (ImHashStr in imgui.cpp) over label lengths typical of the overlay menu. Compares the
+// lookup table byte loop, the SSE 4.2 byte loop and the word loop the arm64 build uses (strlen, then 8 bytes per CRC32
+// instruction), here run with the x86 CRC32c instructions, which compute the same CRC as the arm64 ones. All variants must
+// give the IDs ImHashStr gives; returns non-zero on a mismatch.
+// Usage: hash_benchmark [iterations]
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+#if defined(__SSE4_2__)
+#include <nmmintrin.h>
+#define HASH_CRC32_U8(crc, c)   _mm_crc32_u8(crc, c)
+#define HASH_CRC32_U64(crc, v)  (ImU32)_mm_crc32_u64(crc, v)
+#elif defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#define HASH_CRC32_U8(crc, c)   __crc32cb(crc, c)
+#define HASH_CRC32_U64(crc, v)  __crc32cd(crc, v)
+#endif
+
+// CRC32c table, same as imgui.cpp's GCrc32LookupTable, generated rather than copied.
+static ImU32 g_Table[256];
+static void buildTable() {
+    for (ImU32 i = 0; i < 256; i++) {
+        ImU32 crc = i;
+        for (int bit = 0; bit < 8; bit++) crc = (crc >> 1) ^ (crc & 1 ? 0x82F63B78u : 0);
+        g_Table[i] = crc;
+    }
+}
+
+// Zero-terminated variants, with the "###" reset of ImHashStr.
+static ImGuiID hashTable(const char* str, ImGuiID seed) {
+    seed = ~seed;
+    ImU32 crc = seed;
+    const unsigned char* data = (const unsigned char*)str;
+    while (unsigned char c = *data++) {
+        if (c == '#' && data[0] == '#' && data[1] == '#') crc = seed;
+        crc = (crc >> 8) ^ g_Table[(crc & 0xFF) ^ c];
+    }
+    return ~crc;
+}
+
+#ifdef HASH_CRC32_U8
+static ImGuiID hashBytes(const char* str, ImGuiID seed) {
+    seed = ~seed;
+    ImU32 crc = seed;
+    const unsigned char* data = (const unsigned char*)str;
+    while (unsigned char c = *data++) {
+        if (c == '#' && data[0] == '#' && data[1] == '#') crc = seed;
+        crc = HASH_CRC32_U8(crc, c);
+    }
+    return ~crc;
+}
+
+static ImGuiID hashWords(const char* str, ImGuiID seed) {
+    size_t size = strlen(str);
+    seed = ~seed;
+    ImU32 crc = seed;
+    const unsigned char* data = (const unsigned char*)str;
+    const ImU64 ones = 0x0101010101010101ULL, highs = 0x8080808080808080ULL, hashes = 0x2323232323232323ULL;
+    while (size-- != 0) {
+        ImU64 v;
+        if (size >= 7 && (memcpy(&v, data, 8), ((((v - ones) & ~v) | (((v ^ hashes) - ones) & ~(v ^ hashes))) & highs) == 0)) {
+            crc = HASH_CRC32_U64(crc, v);
+            data += 8; size -= 7;
+            continue;
+        }
+        unsigned char c = *data++;
+        if (c == '#' && size >= 2 && data[0] == '#' && data[1] == '#') crc = seed;
+        crc = HASH_CRC32_U8(crc, c);
+    }
+    return ~crc;
+}
+#endif
+
+static ImGuiID hashImGui(const char* str, ImGuiID seed) { return ImHashStr(str, 0, seed); }
+
+typedef ImGuiID (*HashFn)(const char*, ImGuiID);
+
+// Average ns per hash over the labels, which are chained through the seed like PushID/GetID chains do.
+static double timeHash(HashFn fn, const std::vector<const char*>& labels, int iterations, ImGuiID& sink) {
+    ImGuiID seed = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; i++)
+        for (const char* label : labels) seed = fn(label, seed);
+    auto t1 = std::chrono::steady_clock::now();
+    sink += seed;
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / ((double)iterations * labels.size());
+}
+
+int main(int argc, char** argv) {
+    const int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    buildTable();
+
+    // Labels of the menu's widgets, then synthetic lengths around and beyond them
+    static const char* const menuLabels[] = { "AnarchyArray Menu", "Minecraft Patches", "InfinitySpread", "SpongeRange+", "##absorbDisplay",
+        "K", "i", "-", "+", "AbsorbKeypad", "Visual Effects", "Enable Motion Blur", "##Strength", "##Resolution", "##Path",
+        "##HistoryFormat", "Skip When Static", "Sharpen", "Contrast", "Saturation", "Zero-Copy Capture", "#RESIZE", "#SCROLLY", "Stats###stats" };
+    struct Group { const char* name; std::vector<const char*> labels; };
+    std::vector<Group> groups;
+    groups.push_back({ "menu labels", std::vector<const char*>(std::begin(menuLabels), std::end(menuLabels)) });
+    static char synthetic[5][128];
+    static const int lengths[] = { 4, 8, 16, 32, 96 };
+    for (int n = 0; n < 5; n++) {
+        for (int i = 0; i < lengths[n]; i++) synthetic[n][i] = 'a' + (i * 7) % 26;
+        synthetic[n][lengths[n]] = 0;
+        char name[32];
+        snprintf(name, sizeof(name), "%d bytes", lengths[n]);
+        groups.push_back({ strdup(name), { synthetic[n] } });
+    }
+
+    struct Variant { const char* name; HashFn fn; };
+    std::vector<Variant> variants = { { "table", hashTable } };
+#ifdef HASH_CRC32_U8
+    variants.push_back({ "crc32 bytes", hashBytes });
+    variants.push_back({ "crc32 words", hashWords });
+#endif
+    variants.push_back({ "ImHashStr", hashImGui });
+
+    int mismatches = 0;
+    for (const Group& group : groups)
+        for (const char* label : group.labels)
+            for (const Variant& variant : variants)
+                if (variant.fn(label, 0x1234) != ImHashStr(label, 0, 0x1234)) { fprintf(stderr, "%s differs on \"%s\"\n", variant.name, label); mismatches++; }
+
+    ImGuiID sink = 0;
+    printf("%-12s", "ns/hash");
+    for (const Variant& variant : variants) printf("%14s", variant.name);
+    printf("\n");
+    for (const Group& group : groups) {
+        printf("%-12s", group.name);
+        const int scaled = group.labels.size() > 1 ? iterations : iterations * 8;
+        for (const Variant& variant : variants) printf("%14.2f", timeHash(variant.fn, group.labels, scaled, sink));
+        printf("\n");
+    }
+    printf("%d mismatches (%08X)\n", mismatches, sink);
+    return mismatches != 0;
+}
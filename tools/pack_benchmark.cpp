@@ -0,0 +1,101 @@
+// Host benchmark for the font atlas packer (ImFontAtlasPackAddRect in imgui_draw.cpp): replays the glyph sizes of the overlay
+// font at every baked scale in random order, discarding a share of them between rounds like font rebakes do, then checks
+// that no two live rectangles overlap. Returns non-zero on an overlap or a rectangle outside the texture.
+// Usage: pack_benchmark [rounds]
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "BakedFont.h"
+
+struct RectSize { int w, h; };
+
+// Sizes of the rectangles the atlas packs for Latin-1 glyphs of the default font at every baked scale.
+static std::vector<RectSize> collectGlyphSizes() {
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+    ImFont* font = io.Fonts->AddFontDefault();
+    ImGui::NewFrame();
+    std::vector<RectSize> sizes;
+    for (float scale = kBakedFontScaleMin; scale <= kBakedFontScaleMax + 0.001f; scale += kBakedFontScaleStep) {
+        ImFontBaked* baked = font->GetFontBaked(kBakedFontBaseSize * scale, 1.0f);
+        for (unsigned c = 0x21; c <= 0xFF; c++) {
+            ImFontGlyph* glyph = baked->FindGlyphNoFallback((ImWchar)c);
+            if (!glyph || glyph->PackId == ImFontAtlasRectId_Invalid) continue;
+            ImTextureRect* r = ImFontAtlasPackGetRect(io.Fonts, glyph->PackId);
+            sizes.push_back({ r->w, r->h });
+        }
+    }
+    ImGui::EndFrame();
+    ImGui::DestroyContext();
+    return sizes;
+}
+
+int main(int argc, char** argv) {
+    const int rounds = argc > 1 ? atoi(argv[1]) : 40;
+    std::vector<RectSize> sizes = collectGlyphSizes();
+    if (sizes.empty()) { fprintf(stderr, "no glyphs\n"); return 1; }
+
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(1280.0f, 720.0f);
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasTextures;
+    io.Fonts->AddFontDefault();
+    ImGui::NewFrame();
+    ImGui::EndFrame();
+    ImFontAtlas* atlas = io.Fonts;
+
+    // Each round adds one font's worth of glyphs and discards 40% of what is live, so holes keep appearing.
+    std::mt19937 rng(42);
+    std::vector<ImFontAtlasRectId> live;
+    const int perRound = (int)sizes.size() / 11;
+    int added = 0, maxNodes = 0, maxHoles = 0;
+    double addMs = 0.0, discardMs = 0.0;
+    for (int round = 0; round < rounds; round++) {
+        auto t0 = std::chrono::steady_clock::now();
+        for (int i = 0; i < perRound; i++) {
+            const RectSize& s = sizes[rng() % sizes.size()];
+            ImFontAtlasRectId id = ImFontAtlasPackAddRect(atlas, s.w, s.h);
+            if (id != ImFontAtlasRectId_Invalid) live.push_back(id);
+        }
+        auto t1 = std::chrono::steady_clock::now();
+        std::shuffle(live.begin(), live.end(), rng);
+        for (size_t n = live.size() * 2 / 5; n > 0; n--) { ImFontAtlasPackDiscardRect(atlas, live.back()); live.pop_back(); }
+        auto t2 = std::chrono::steady_clock::now();
+        addMs += std::chrono::duration<double, std::milli>(t1 - t0).count();
+        discardMs += std::chrono::duration<double, std::milli>(t2 - t1).count();
+        added += perRound;
+        int holes = 0;
+        for (const ImVector<ImTextureRect>& bucket : atlas->Builder->PackHoles) holes += bucket.Size;
+        maxNodes = std::max(maxNodes, atlas->Builder->PackSkyline.Size);
+        maxHoles = std::max(maxHoles, holes);
+    }
+
+    // Repacks move rectangles, so bounds and overlaps are checked on the final positions.
+    ImTextureData* tex = atlas->TexData;
+    const int pad = atlas->TexGlyphPadding;
+    std::vector<ImTextureRect> rects;
+    for (ImFontAtlasRectId id : live) rects.push_back(*ImFontAtlasPackGetRect(atlas, id));
+    int bad = 0;
+    for (const ImTextureRect& r : rects) if (r.x + r.w + pad > tex->Width || r.y + r.h + pad > tex->Height) bad++;
+    std::sort(rects.begin(), rects.end(), [](const ImTextureRect& a, const ImTextureRect& b) { return a.x < b.x; });
+    for (size_t i = 0; i < rects.size(); i++)
+        for (size_t j = i + 1; j < rects.size() && rects[j].x < rects[i].x + rects[i].w + pad; j++) {
+            const ImTextureRect& a = rects[i]; const ImTextureRect& b = rects[j];
+            if (a.y < b.y + b.h + pad && b.y < a.y + a.h + pad) bad++;
+        }
+
+    printf("%zu glyph sizes, %d rounds: %d adds in %.2f ms (%.0f ns each), discards %.2f ms\n", sizes.size(), rounds, added, addMs, addMs * 1.0e6 / added, discardMs);
+    printf("texture %dx%d, %zu live, at most %d skyline nodes and %d holes, %d overlapping or out of bounds\n", tex->Width, tex->Height, rects.size(), maxNodes, maxHoles, bad);
+    ImGui::DestroyContext();
+    return bad != 0;
+}